@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "asm.h"
+
+void asm_init(AsmBuffer* buffer) {
+    buffer->insns = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+}
+
+void asm_free(AsmBuffer* buffer) {
+    free(buffer->insns);
+    asm_init(buffer);
+}
+
+static AsmInsn* append(AsmBuffer* buffer, AsmKind kind) {
+    if (buffer->count == buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 64;
+        buffer->insns = (AsmInsn*)realloc(buffer->insns, (size_t)buffer->capacity * sizeof(AsmInsn));
+        if (!buffer->insns) {
+            perror("Errore di allocazione del buffer assembly");
+            exit(EXIT_FAILURE);
+        }
+    }
+    AsmInsn* insn = &buffer->insns[buffer->count++];
+    memset(insn, 0, sizeof(AsmInsn));
+    insn->kind = kind;
+    return insn;
+}
+
+static void copy_operand(AsmInsn* insn, const char* start, size_t length) {
+    while (length > 0 && *start == ' ') {
+        start++;
+        length--;
+    }
+    while (length > 0 && start[length - 1] == ' ') length--;
+    if (insn->noperands == ASM_MAX_OPERANDS || length >= ASM_OPERAND_LEN) {
+        fprintf(stderr, "Errore interno: operando assembly non valido.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(insn->operands[insn->noperands], start, length);
+    insn->operands[insn->noperands][length] = '\0';
+    insn->noperands++;
+}
+
+void asm_emit(AsmBuffer* buffer, const char* format, ...) {
+    char line[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    AsmInsn* insn = append(buffer, line[0] == '.' ? ASM_DIRECTIVE : ASM_INSN);
+    size_t length = strcspn(line, " ");
+    if (length >= sizeof(insn->mnemonic)) {
+        fprintf(stderr, "Errore interno: mnemonico assembly non valido.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(insn->mnemonic, line, length);
+    const char* rest = line + length;
+    if (*rest == '\0') return;
+    if (insn->kind == ASM_DIRECTIVE) {
+        copy_operand(insn, rest, strlen(rest));
+        return;
+    }
+    // Le virgole dentro le parentesi separano base, indice e scala, non gli operandi
+    int depth = 0;
+    const char* start = rest;
+    for (const char* p = rest; ; p++) {
+        if (*p == '(') depth++;
+        if (*p == ')') depth--;
+        if (*p == '\0' || (*p == ',' && depth == 0)) {
+            copy_operand(insn, start, (size_t)(p - start));
+            if (*p == '\0') break;
+            start = p + 1;
+        }
+    }
+}
+
+void asm_label(AsmBuffer* buffer, const char* format, ...) {
+    AsmInsn* insn = append(buffer, ASM_LABEL);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(insn->operands[0], ASM_OPERAND_LEN, format, args);
+    va_end(args);
+    insn->noperands = 1;
+}
+
+void asm_compact(AsmBuffer* buffer) {
+    int kept = 0;
+    for (int i = 0; i < buffer->count; i++) {
+        if (!buffer->insns[i].deleted) buffer->insns[kept++] = buffer->insns[i];
+    }
+    buffer->count = kept;
+}
+
+void asm_write(AsmBuffer* buffer, FILE* out) {
+    for (int i = 0; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted) continue;
+        if (insn->kind == ASM_LABEL) {
+            fprintf(out, "%s:\n", insn->operands[0]);
+            continue;
+        }
+        fprintf(out, "  %s", insn->mnemonic);
+        for (int k = 0; k < insn->noperands; k++) {
+            fprintf(out, "%s%s", k == 0 ? " " : ", ", insn->operands[k]);
+        }
+        fprintf(out, "\n");
+    }
+}
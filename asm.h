@@ -0,0 +1,48 @@
+#ifndef ASM_H
+#define ASM_H
+
+#include <stdio.h>
+
+// Buffer delle istruzioni assembly di una funzione. Il backend (x86.c) accoda le istruzioni
+// già scomposte in mnemonico e operandi (sintassi AT&T, sorgente prima della destinazione),
+// asm_peephole le riscrive e asm_write le stampa sul file di uscita.
+
+#define ASM_MAX_OPERANDS 3
+#define ASM_OPERAND_LEN 32
+
+typedef enum {
+    ASM_INSN,       // istruzione: mnemonico e operandi
+    ASM_LABEL,      // etichetta: il nome in operands[0]
+    ASM_DIRECTIVE   // direttiva (.globl, .p2align): gli argomenti, non scomposti, in operands[0]
+} AsmKind;
+
+typedef struct {
+    AsmKind kind;
+    char mnemonic[16];
+    char operands[ASM_MAX_OPERANDS][ASM_OPERAND_LEN];
+    int noperands;
+    int deleted;    // tolta da un passo del peephole, sparisce alla compattazione successiva
+} AsmInsn;
+
+typedef struct {
+    AsmInsn* insns;
+    int count;
+    int capacity;
+} AsmBuffer;
+
+void asm_init(AsmBuffer* buffer);
+void asm_free(AsmBuffer* buffer);
+
+// Accoda una riga nel formato di printf, per esempio asm_emit(b, "movl %d(%%ebp), %%eax", off).
+// Le righe che iniziano con '.' sono direttive.
+void asm_emit(AsmBuffer* buffer, const char* format, ...);
+void asm_label(AsmBuffer* buffer, const char* format, ...);
+
+// Toglie dal buffer le istruzioni marcate come cancellate.
+void asm_compact(AsmBuffer* buffer);
+void asm_write(AsmBuffer* buffer, FILE* out);
+
+// Ottimizzazione a finestra sulle istruzioni di una funzione (peephole.c)
+void asm_peephole(AsmBuffer* buffer);
+
+#endif // ASM_H
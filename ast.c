@@ -14,27 +14,33 @@ Node* new_node(NodeType type, ...) {
         exit(1);
     }
     node->type = type;
+    node->slot = -1;
+    node->name_hash = 0;
 
     va_list args;
     va_start(args, type);
 
     switch (type) {
         case NODE_PROGRAM:
-            node->program_node.function = va_arg(args, Node*);
+            node->program_node.functions = va_arg(args, List*);
             break;
         case NODE_FUNCTION:
             node->function_def.name = va_arg(args, char*);
+            node->name_hash = identifier_hash(node->function_def.name);
             node->function_def.declarations = va_arg(args, List*);
             node->function_def.statements = va_arg(args, List*);
+            node->function_def.frame_slots = 0;
             break;
         case NODE_DECLARATION:
             node->declaration_stmt.identifier = va_arg(args, char*);
+            node->name_hash = identifier_hash(node->declaration_stmt.identifier);
             break;
         case NODE_NUMBER:
             node->number_val = va_arg(args, int);
             break;
         case NODE_IDENTIFIER:
             node->identifier_name = va_arg(args, char*);
+            node->name_hash = identifier_hash(node->identifier_name);
             break;
         case NODE_PLUS:
         case NODE_MINUS:
@@ -50,6 +56,7 @@ Node* new_node(NodeType type, ...) {
         case NODE_ASSIGN_OP:
             node->assign_op.identifier = va_arg(args, char*);
             node->assign_op.expression = va_arg(args, Node*);
+            node->name_hash = identifier_hash(node->assign_op.identifier);
             break;
         case NODE_IF_STMT:
         case NODE_IF_ELSE_STMT:
@@ -72,6 +79,15 @@ Node* new_node(NodeType type, ...) {
     return node;
 }
 
+unsigned int identifier_hash(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 List* reverse_list(List* list) {
     List* prev = NULL;
     List* current = list;
@@ -99,6 +115,10 @@ List* new_list(Node *node, List *next) {
 }
 
 
+Node* create_program_node(List* functions) {
+    return new_node(NODE_PROGRAM, reverse_list(functions));
+}
+
 Node* create_function_node(char* name, List* declarations, List* statements) {
     // Inverti le liste per ottenere l'ordine corretto
     List* reversed_declarations = reverse_list(declarations);
@@ -154,132 +174,415 @@ List* create_list_node(Node* node, List* next) {
     return new_list(node, next);
 }
 
-void print_ast(Node *node, int indent) {
+// Unisce dichiarazioni e istruzioni di un blocco in un'unica lista. Le due liste arrivano dal parser
+// in ordine inverso, quindi le dichiarazioni vanno in coda: dopo l'inversione saranno in testa al blocco.
+List* create_block_list(List* declarations, List* statements) {
+    if (!statements) return declarations;
+    List* last = statements;
+    while (last->next) {
+        last = last->next;
+    }
+    last->next = declarations;
+    return statements;
+}
+
+// Buffer di uscita per la stampa dell'AST.
+// Le stampe dell'albero producono moltissime scritture piccole: invece di una printf per ognuna
+// le accumuliamo in un buffer grande e lo scarichiamo sul file con una sola fwrite quando è pieno.
+#define AST_OUT_BUFFER_SIZE (1 << 16)
+
+static char out_buffer[AST_OUT_BUFFER_SIZE];
+static size_t out_len = 0;
+static FILE* out_file = NULL;
+static int dot_node_count = 0;
+
+static void out_flush(void) {
+    if (out_len > 0) {
+        fwrite(out_buffer, 1, out_len, out_file);
+        out_len = 0;
+    }
+}
+
+static void out_write(const char* text, size_t len) {
+    if (len > AST_OUT_BUFFER_SIZE - out_len) {
+        out_flush();
+        if (len > AST_OUT_BUFFER_SIZE) {
+            fwrite(text, 1, len, out_file);
+            return;
+        }
+    }
+    memcpy(out_buffer + out_len, text, len);
+    out_len += len;
+}
+
+static void out_puts(const char* text) {
+    out_write(text, strlen(text));
+}
+
+static void out_int(int value) {
+    char digits[16];
+    int len = snprintf(digits, sizeof(digits), "%d", value);
+    out_write(digits, (size_t)len);
+}
+
+static void out_indent(int indent) {
+    static const char spaces[] = "                                                                ";
+    size_t len = (size_t)indent * 2;
+    while (len > 0) {
+        size_t chunk = len < sizeof(spaces) - 1 ? len : sizeof(spaces) - 1;
+        out_write(spaces, chunk);
+        len -= chunk;
+    }
+}
+
+// Simbolo dell'operatore per i nodi binari, NULL per gli altri nodi.
+static const char* binary_op_symbol(NodeType type) {
+    switch (type) {
+        case NODE_PLUS: return "+";
+        case NODE_MINUS: return "-";
+        case NODE_MULT: return "*";
+        case NODE_DIVIDE: return "/";
+        case NODE_EQUAL_OP: return "==";
+        case NODE_NOT_EQUAL_OP: return "!=";
+        case NODE_LESS_THAN_OP: return "<";
+        case NODE_GREATER_THAN_OP: return ">";
+        default: return NULL;
+    }
+}
+
+// Stampa testuale (il formato storico di print_ast).
+static void dump_text_list(List* list, int indent);
+
+static void dump_text(Node* node, int indent) {
     if (!node) return;
-    
-    for (int i = 0; i < indent; i++) printf("  ");
+
+    out_indent(indent);
+
+    const char* op = binary_op_symbol(node->type);
+    if (op) {
+        out_puts(op);
+        out_puts("\n");
+        dump_text(node->binary_op.left, indent + 1);
+        dump_text(node->binary_op.right, indent + 1);
+        return;
+    }
 
     switch (node->type) {
         case NODE_PROGRAM:
-            printf("Program\n");
-            print_ast(node->program_node.function, indent + 1);
+            out_puts("Program\n");
+            dump_text_list(node->program_node.functions, indent + 1);
             break;
         case NODE_FUNCTION:
-            printf("Function: %s\n", node->function_def.name);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Declarations:\n");
-            print_list(node->function_def.declarations, indent + 2);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Statements:\n");
-            print_list(node->function_def.statements, indent + 2);
+            out_puts("Function: ");
+            out_puts(node->function_def.name);
+            out_puts("\n");
+            out_indent(indent + 1);
+            out_puts("Declarations:\n");
+            dump_text_list(node->function_def.declarations, indent + 2);
+            out_indent(indent + 1);
+            out_puts("Statements:\n");
+            dump_text_list(node->function_def.statements, indent + 2);
             break;
         case NODE_DECLARATION:
-            printf("Declaration: %s\n", node->declaration_stmt.identifier);
+            out_puts("Declaration: ");
+            out_puts(node->declaration_stmt.identifier);
+            out_puts("\n");
             break;
         case NODE_NUMBER:
-            printf("Number: %d\n", node->number_val);
+            out_puts("Number: ");
+            out_int(node->number_val);
+            out_puts("\n");
             break;
         case NODE_IDENTIFIER:
-            printf("Identifier: %s\n", node->identifier_name);
+            out_puts("Identifier: ");
+            out_puts(node->identifier_name);
+            out_puts("\n");
             break;
-        case NODE_PLUS:
-            printf("+\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+        case NODE_ASSIGN_OP:
+            out_puts("=\n");
+            out_indent(indent + 1);
+            out_puts("Identifier: ");
+            out_puts(node->assign_op.identifier);
+            out_puts("\n");
+            dump_text(node->assign_op.expression, indent + 1);
             break;
-        case NODE_MINUS:
-            printf("-\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+        case NODE_IF_STMT:
+        case NODE_IF_ELSE_STMT:
+            out_puts(node->type == NODE_IF_STMT ? "If Statement\n" : "If-Else Statement\n");
+            out_indent(indent + 1);
+            out_puts("Condition:\n");
+            dump_text(node->if_stmt.condition, indent + 2);
+            out_indent(indent + 1);
+            out_puts("If Body:\n");
+            dump_text_list(node->if_stmt.if_body, indent + 2);
+            if (node->type == NODE_IF_ELSE_STMT || node->if_stmt.else_body) {
+                out_indent(indent + 1);
+                out_puts("Else Body:\n");
+                dump_text_list(node->if_stmt.else_body, indent + 2);
+            }
             break;
-        case NODE_MULT:
-            printf("*\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+        case NODE_WHILE_STMT:
+            out_puts("While Statement\n");
+            out_indent(indent + 1);
+            out_puts("Condition:\n");
+            dump_text(node->while_stmt.condition, indent + 2);
+            out_indent(indent + 1);
+            out_puts("While Body:\n");
+            dump_text_list(node->while_stmt.while_body, indent + 2);
             break;
-        case NODE_DIVIDE:
-            printf("/\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+        case NODE_RETURN_STMT:
+            out_puts("Return Statement\n");
+            dump_text(node->return_stmt.expression, indent + 1);
             break;
-        case NODE_ASSIGN_OP:
-            printf("=\n");
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Identifier: %s\n", node->assign_op.identifier);
-            print_ast(node->assign_op.expression, indent + 1);
+        case NODE_EXPR_STMT:
+            out_puts("Expression Statement\n");
+            dump_text(node->expr_stmt.expression, indent + 1);
             break;
-        case NODE_EQUAL_OP:
-            printf("==\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+        default:
+            out_puts("?\n");
             break;
-        case NODE_NOT_EQUAL_OP:
-            printf("!=\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+    }
+}
+
+static void dump_text_list(List* list, int indent) {
+    for (List* current = list; current != NULL; current = current->next) {
+        dump_text(current->node, indent);
+    }
+}
+
+// Stampa JSON compatta: un oggetto per nodo, le liste diventano array.
+// Gli identificatori accettati dal lexer sono solo alfanumerici, quindi non serve l'escape delle stringhe.
+static void dump_json(Node* node);
+
+static void dump_json_string(const char* key, const char* value) {
+    out_puts(",\"");
+    out_puts(key);
+    out_puts("\":\"");
+    out_puts(value);
+    out_puts("\"");
+}
+
+static void dump_json_list(const char* key, List* list) {
+    out_puts(",\"");
+    out_puts(key);
+    out_puts("\":[");
+    for (List* current = list; current != NULL; current = current->next) {
+        dump_json(current->node);
+        if (current->next) out_puts(",");
+    }
+    out_puts("]");
+}
+
+static void dump_json_child(const char* key, Node* child) {
+    out_puts(",\"");
+    out_puts(key);
+    out_puts("\":");
+    dump_json(child);
+}
+
+static void dump_json(Node* node) {
+    if (!node) {
+        out_puts("null");
+        return;
+    }
+
+    const char* op = binary_op_symbol(node->type);
+    if (op) {
+        out_puts("{\"type\":\"BinaryOp\"");
+        dump_json_string("op", op);
+        dump_json_child("left", node->binary_op.left);
+        dump_json_child("right", node->binary_op.right);
+        out_puts("}");
+        return;
+    }
+
+    switch (node->type) {
+        case NODE_PROGRAM:
+            out_puts("{\"type\":\"Program\"");
+            dump_json_list("functions", node->program_node.functions);
             break;
-        case NODE_LESS_THAN_OP:
-            printf("<\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+        case NODE_FUNCTION:
+            out_puts("{\"type\":\"Function\"");
+            dump_json_string("name", node->function_def.name);
+            dump_json_list("declarations", node->function_def.declarations);
+            dump_json_list("statements", node->function_def.statements);
             break;
-        case NODE_GREATER_THAN_OP:
-            printf(">\n");
-            print_ast(node->binary_op.left, indent + 1);
-            print_ast(node->binary_op.right, indent + 1);
+        case NODE_DECLARATION:
+            out_puts("{\"type\":\"Declaration\"");
+            dump_json_string("identifier", node->declaration_stmt.identifier);
+            break;
+        case NODE_NUMBER:
+            out_puts("{\"type\":\"Number\",\"value\":");
+            out_int(node->number_val);
+            break;
+        case NODE_IDENTIFIER:
+            out_puts("{\"type\":\"Identifier\"");
+            dump_json_string("name", node->identifier_name);
+            break;
+        case NODE_ASSIGN_OP:
+            out_puts("{\"type\":\"Assign\"");
+            dump_json_string("identifier", node->assign_op.identifier);
+            dump_json_child("expression", node->assign_op.expression);
             break;
         case NODE_IF_STMT:
-            printf("If Statement\n");
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Condition:\n");
-            print_ast(node->if_stmt.condition, indent + 2);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("If Body:\n");
-            print_list(node->if_stmt.if_body, indent + 2);
-            if (node->if_stmt.else_body) {
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("Else Body:\n");
-                print_list(node->if_stmt.else_body, indent + 2);
-            }
+        case NODE_IF_ELSE_STMT:
+            out_puts(node->type == NODE_IF_STMT ? "{\"type\":\"If\"" : "{\"type\":\"IfElse\"");
+            dump_json_child("condition", node->if_stmt.condition);
+            dump_json_list("if_body", node->if_stmt.if_body);
+            dump_json_list("else_body", node->if_stmt.else_body);
+            break;
+        case NODE_WHILE_STMT:
+            out_puts("{\"type\":\"While\"");
+            dump_json_child("condition", node->while_stmt.condition);
+            dump_json_list("body", node->while_stmt.while_body);
             break;
+        case NODE_RETURN_STMT:
+            out_puts("{\"type\":\"Return\"");
+            dump_json_child("expression", node->return_stmt.expression);
+            break;
+        case NODE_EXPR_STMT:
+            out_puts("{\"type\":\"ExprStmt\"");
+            dump_json_child("expression", node->expr_stmt.expression);
+            break;
+        default:
+            out_puts("{\"type\":\"Unknown\"");
+            break;
+    }
+    out_puts("}");
+}
+
+// Stampa Graphviz DOT: ogni nodo riceve un identificatore progressivo "nN",
+// gli archi sono etichettati con il ruolo del figlio (condition, body, ...).
+static int dump_dot(Node* node);
+
+static void dump_dot_edge(int from, int to, const char* role) {
+    out_puts("  n");
+    out_int(from);
+    out_puts(" -> n");
+    out_int(to);
+    out_puts(" [label=\"");
+    out_puts(role);
+    out_puts("\"];\n");
+}
+
+static void dump_dot_child(int parent, Node* child, const char* role) {
+    if (!child) return;
+    dump_dot_edge(parent, dump_dot(child), role);
+}
+
+static void dump_dot_list(int parent, List* list, const char* role) {
+    for (List* current = list; current != NULL; current = current->next) {
+        dump_dot_child(parent, current->node, role);
+    }
+}
+
+static void dump_dot_label(int id, const char* label, const char* detail) {
+    out_puts("  n");
+    out_int(id);
+    out_puts(" [label=\"");
+    out_puts(label);
+    if (detail) {
+        out_puts("\\n");
+        out_puts(detail);
+    }
+    out_puts("\"];\n");
+}
+
+static int dump_dot(Node* node) {
+    int id = dot_node_count++;
+    char number[16];
+
+    const char* op = binary_op_symbol(node->type);
+    if (op) {
+        dump_dot_label(id, op, NULL);
+        dump_dot_child(id, node->binary_op.left, "left");
+        dump_dot_child(id, node->binary_op.right, "right");
+        return id;
+    }
+
+    switch (node->type) {
+        case NODE_PROGRAM:
+            dump_dot_label(id, "Program", NULL);
+            dump_dot_list(id, node->program_node.functions, "function");
+            break;
+        case NODE_FUNCTION:
+            dump_dot_label(id, "Function", node->function_def.name);
+            dump_dot_list(id, node->function_def.declarations, "decl");
+            dump_dot_list(id, node->function_def.statements, "stmt");
+            break;
+        case NODE_DECLARATION:
+            dump_dot_label(id, "Declaration", node->declaration_stmt.identifier);
+            break;
+        case NODE_NUMBER:
+            snprintf(number, sizeof(number), "%d", node->number_val);
+            dump_dot_label(id, "Number", number);
+            break;
+        case NODE_IDENTIFIER:
+            dump_dot_label(id, "Identifier", node->identifier_name);
+            break;
+        case NODE_ASSIGN_OP:
+            dump_dot_label(id, "=", node->assign_op.identifier);
+            dump_dot_child(id, node->assign_op.expression, "expression");
+            break;
+        case NODE_IF_STMT:
         case NODE_IF_ELSE_STMT:
-            printf("If-Else Statement\n");
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Condition:\n");
-            print_ast(node->if_stmt.condition, indent + 2);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("If Body:\n");
-            print_list(node->if_stmt.if_body, indent + 2);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Else Body:\n");
-            print_list(node->if_stmt.else_body, indent + 2);
+            dump_dot_label(id, node->type == NODE_IF_STMT ? "If" : "If-Else", NULL);
+            dump_dot_child(id, node->if_stmt.condition, "condition");
+            dump_dot_list(id, node->if_stmt.if_body, "then");
+            dump_dot_list(id, node->if_stmt.else_body, "else");
             break;
         case NODE_WHILE_STMT:
-            printf("While Statement\n");
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("Condition:\n");
-            print_ast(node->while_stmt.condition, indent + 2);
-            for (int i = 0; i < indent + 1; i++) printf("  ");
-            printf("While Body:\n");
-            print_list(node->while_stmt.while_body, indent + 2);
+            dump_dot_label(id, "While", NULL);
+            dump_dot_child(id, node->while_stmt.condition, "condition");
+            dump_dot_list(id, node->while_stmt.while_body, "body");
             break;
         case NODE_RETURN_STMT:
-            printf("Return Statement\n");
-            print_ast(node->return_stmt.expression, indent + 1);
+            dump_dot_label(id, "Return", NULL);
+            dump_dot_child(id, node->return_stmt.expression, "expression");
             break;
         case NODE_EXPR_STMT:
-            printf("Expression Statement\n");
-            print_ast(node->expr_stmt.expression, indent + 1);
+            dump_dot_label(id, "Expression Statement", NULL);
+            dump_dot_child(id, node->expr_stmt.expression, "expression");
+            break;
+        default:
+            dump_dot_label(id, "?", NULL);
             break;
     }
+    return id;
 }
 
-void print_list(List *list, int indent) {
-    List *current = list;
-    while (current != NULL) {
-        print_ast(current->node, indent);
-        current = current->next;
+// Stampa l'AST sul file indicato nel formato richiesto, passando per il buffer.
+void dump_ast(Node* node, AstDumpFormat format, FILE* out) {
+    out_file = out;
+    switch (format) {
+        case AST_DUMP_TEXT:
+            dump_text(node, 0);
+            break;
+        case AST_DUMP_JSON:
+            dump_json(node);
+            out_puts("\n");
+            break;
+        case AST_DUMP_DOT:
+            dot_node_count = 0;
+            out_puts("digraph AST {\n  node [shape=box];\n");
+            if (node) dump_dot(node);
+            out_puts("}\n");
+            break;
     }
+    out_flush();
+    fflush(out);
+}
+
+void print_ast(Node *node, int indent) {
+    out_file = stdout;
+    dump_text(node, indent);
+    out_flush();
+}
+
+void print_list(List *list, int indent) {
+    out_file = stdout;
+    dump_text_list(list, indent);
+    out_flush();
 }
 
 void free_ast(Node* node) {
@@ -287,7 +590,7 @@ void free_ast(Node* node) {
 
     switch (node->type) {
         case NODE_PROGRAM:
-            free_ast(node->program_node.function);
+            free_list(node->program_node.functions);
             break;
         case NODE_FUNCTION:
             free(node->function_def.name);
@@ -36,6 +36,12 @@ typedef enum {
 // Struttura di un nodo dell'albero sintattico
 struct Node {
     NodeType type;
+    // Slot nel frame della variabile (NODE_IDENTIFIER, NODE_ASSIGN_OP, NODE_DECLARATION),
+    // assegnato dall'analisi semantica; -1 finché non è risolto
+    int slot;
+    // Hash del nome (identifier_hash) per NODE_IDENTIFIER, NODE_ASSIGN_OP, NODE_DECLARATION e NODE_FUNCTION,
+    // calcolato una sola volta alla creazione del nodo e riusato da ogni ricerca nella tabella dei simboli
+    unsigned int name_hash;
     union {
         // NODES BINARI
         struct {
@@ -82,13 +88,14 @@ struct Node {
         
         // NODES DI PROGRAMMA E FUNZIONE
         struct {
-            Node* function;
+            List* functions;
         } program_node;
         
         struct {
             char* name;
             List* declarations;
             List* statements;
+            int frame_slots; // numero di slot da riservare nel frame
         } function_def;
     };
 };
@@ -104,6 +111,7 @@ Node* new_node(NodeType type, ...);
 List* new_list(Node* node, List* next);
 
 // Funzioni helper per la creazione dei nodi specifici
+Node* create_program_node(List* functions);
 Node* create_function_node(char* name, List* declarations, List* statements);
 Node* create_declaration_node(char* identifier);
 Node* create_return_node(Node* expression);
@@ -115,10 +123,22 @@ Node* create_identifier_node(char* name);
 Node* create_if_node(Node* condition, List* if_body, List* else_body);
 Node* create_while_node(Node* condition, List* while_body);
 List* create_list_node(Node* node, List* next);
+List* create_block_list(List* declarations, List* statements);
+
+// Hash FNV-1a di un identificatore
+unsigned int identifier_hash(const char* name);
+
+// Formati disponibili per la stampa dell'AST (--dump-ast)
+typedef enum {
+    AST_DUMP_TEXT,
+    AST_DUMP_JSON,
+    AST_DUMP_DOT
+} AstDumpFormat;
 
 // Funzioni per la stampa
 void print_ast(Node* node, int indent);
 void print_list(List* list, int indent);
+void dump_ast(Node* node, AstDumpFormat format, FILE* out);
 
 // Funzione per la pulizia della memoria
 void free_ast(Node* node);
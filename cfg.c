@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "cfg.h"
+
+static void* checked_malloc(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        perror("Errore di allocazione del grafo di flusso");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+void cfg_free(IrFunction* fn) {
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        free(block->dom_children);
+        block->dom_children = NULL;
+        block->ndom_children = 0;
+        block->idom = NULL;
+        block->loop = NULL;
+        block->loop_depth = 0;
+        block->rpo_index = -1;
+    }
+    for (int i = 0; i < fn->nloops; i++) {
+        free(fn->loops[i]->blocks);
+        free(fn->loops[i]->latches);
+        free(fn->loops[i]);
+    }
+    free(fn->loops);
+    free(fn->rpo);
+    fn->loops = NULL;
+    fn->nloops = 0;
+    fn->rpo = NULL;
+    fn->nrpo = 0;
+}
+
+// Visita in profondità iterativa dall'ingresso: i blocchi escono in postordine,
+// che poi viene invertito. I blocchi non visitati restano con rpo_index = -1.
+static void compute_rpo(IrFunction* fn) {
+    IrBlock** postorder = (IrBlock**)checked_malloc(sizeof(IrBlock*) * fn->nblocks);
+    IrBlock** stack = (IrBlock**)checked_malloc(sizeof(IrBlock*) * fn->nblocks);
+    int* next_succ = (int*)checked_malloc(sizeof(int) * fn->nblocks);
+    int count = 0;
+    int top = 0;
+
+    // Durante la visita rpo_index vale 0 per i blocchi già raggiunti.
+    for (int i = 0; i < fn->nblocks; i++) {
+        fn->blocks[i]->rpo_index = -1;
+    }
+
+    IrBlock* entry = fn->blocks[0];
+    entry->rpo_index = 0;
+    stack[top] = entry;
+    next_succ[top++] = 0;
+    while (top > 0) {
+        IrBlock* block = stack[top - 1];
+        if (next_succ[top - 1] < block->nsucc) {
+            IrBlock* succ = block->succ[next_succ[top - 1]++];
+            if (succ->rpo_index < 0) {
+                succ->rpo_index = 0;
+                stack[top] = succ;
+                next_succ[top++] = 0;
+            }
+        } else {
+            postorder[count++] = block;
+            top--;
+        }
+    }
+
+    fn->rpo = (IrBlock**)checked_malloc(sizeof(IrBlock*) * count);
+    fn->nrpo = count;
+    for (int i = 0; i < count; i++) {
+        fn->rpo[i] = postorder[count - 1 - i];
+        fn->rpo[i]->rpo_index = i;
+    }
+
+    free(postorder);
+    free(stack);
+    free(next_succ);
+}
+
+// "Intersezione" di Cooper-Harvey-Kennedy: risale l'albero dei dominatori parziale
+// dal dito con indice RPO maggiore finché i due diti non si incontrano.
+static IrBlock* intersect(IrBlock* a, IrBlock* b) {
+    while (a != b) {
+        while (a->rpo_index > b->rpo_index) a = a->idom;
+        while (b->rpo_index > a->rpo_index) b = b->idom;
+    }
+    return a;
+}
+
+static void compute_dominators(IrFunction* fn) {
+    IrBlock* entry = fn->rpo[0];
+    entry->idom = entry; // provvisorio: serve a intersect, alla fine torna NULL
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 1; i < fn->nrpo; i++) {
+            IrBlock* block = fn->rpo[i];
+            IrBlock* new_idom = NULL;
+            for (int p = 0; p < block->npreds; p++) {
+                IrBlock* pred = block->preds[p];
+                if (pred->rpo_index < 0 || !pred->idom) continue;
+                new_idom = new_idom ? intersect(pred, new_idom) : pred;
+            }
+            if (block->idom != new_idom) {
+                block->idom = new_idom;
+                changed = 1;
+            }
+        }
+    }
+    entry->idom = NULL;
+
+    // Figli nell'albero dei dominatori
+    for (int i = 1; i < fn->nrpo; i++) {
+        fn->rpo[i]->idom->ndom_children++;
+    }
+    for (int i = 0; i < fn->nrpo; i++) {
+        IrBlock* block = fn->rpo[i];
+        block->dom_children = (IrBlock**)checked_malloc(sizeof(IrBlock*) * block->ndom_children);
+        block->ndom_children = 0;
+    }
+    for (int i = 1; i < fn->nrpo; i++) {
+        IrBlock* parent = fn->rpo[i]->idom;
+        parent->dom_children[parent->ndom_children++] = fn->rpo[i];
+    }
+
+    // Numerazione pre/post dell'albero per rispondere a cfg_dominates in tempo costante
+    IrBlock** stack = (IrBlock**)checked_malloc(sizeof(IrBlock*) * fn->nrpo);
+    int* next_child = (int*)checked_malloc(sizeof(int) * fn->nrpo);
+    int top = 0;
+    int clock = 0;
+    stack[top] = entry;
+    next_child[top++] = 0;
+    entry->dom_pre = clock++;
+    while (top > 0) {
+        IrBlock* block = stack[top - 1];
+        if (next_child[top - 1] < block->ndom_children) {
+            IrBlock* child = block->dom_children[next_child[top - 1]++];
+            child->dom_pre = clock++;
+            stack[top] = child;
+            next_child[top++] = 0;
+        } else {
+            block->dom_post = clock++;
+            top--;
+        }
+    }
+    free(stack);
+    free(next_child);
+}
+
+int cfg_dominates(IrBlock* a, IrBlock* b) {
+    if (a->rpo_index < 0 || b->rpo_index < 0) return 0;
+    return a->dom_pre <= b->dom_pre && b->dom_post <= a->dom_post;
+}
+
+int cfg_loop_contains(IrLoop* loop, IrBlock* block) {
+    for (IrLoop* l = block->loop; l != NULL; l = l->parent) {
+        if (l == loop) return 1;
+    }
+    return 0;
+}
+
+// Il corpo di un ciclo naturale: l'header più tutti i blocchi che raggiungono un latch senza passare dall'header.
+static IrLoop* build_loop(IrFunction* fn, IrBlock* header, char* in_loop) {
+    IrLoop* loop = (IrLoop*)calloc(1, sizeof(IrLoop));
+    IrBlock** worklist = (IrBlock**)checked_malloc(sizeof(IrBlock*) * fn->nrpo);
+    if (!loop) {
+        perror("Errore di allocazione del grafo di flusso");
+        exit(EXIT_FAILURE);
+    }
+    loop->header = header;
+    loop->blocks = (IrBlock**)checked_malloc(sizeof(IrBlock*) * fn->nrpo);
+    loop->latches = (IrBlock**)checked_malloc(sizeof(IrBlock*) * header->npreds);
+
+    for (int i = 0; i < fn->nrpo; i++) in_loop[i] = 0;
+    in_loop[header->rpo_index] = 1;
+    loop->blocks[loop->nblocks++] = header;
+
+    int top = 0;
+    for (int p = 0; p < header->npreds; p++) {
+        IrBlock* pred = header->preds[p];
+        if (pred->rpo_index < 0 || !cfg_dominates(header, pred)) continue;
+        loop->latches[loop->nlatches++] = pred;
+        if (!in_loop[pred->rpo_index]) {
+            in_loop[pred->rpo_index] = 1;
+            loop->blocks[loop->nblocks++] = pred;
+            worklist[top++] = pred;
+        }
+    }
+    while (top > 0) {
+        IrBlock* block = worklist[--top];
+        for (int p = 0; p < block->npreds; p++) {
+            IrBlock* pred = block->preds[p];
+            if (pred->rpo_index < 0 || in_loop[pred->rpo_index]) continue;
+            in_loop[pred->rpo_index] = 1;
+            loop->blocks[loop->nblocks++] = pred;
+            worklist[top++] = pred;
+        }
+    }
+    free(worklist);
+    return loop;
+}
+
+// Trova i cicli naturali (un ciclo per header, unendo i suoi archi all'indietro) e ne ricostruisce
+// l'annidamento. Il codice prodotto da lower.c è strutturato, quindi il grafo è sempre riducibile.
+static void compute_loops(IrFunction* fn) {
+    char* in_loop = (char*)checked_malloc((size_t)fn->nrpo);
+    fn->loops = (IrLoop**)checked_malloc(sizeof(IrLoop*) * fn->nrpo);
+
+    // In ordine RPO un header viene prima dei cicli annidati in lui: i genitori sono già costruiti.
+    for (int i = 0; i < fn->nrpo; i++) {
+        IrBlock* header = fn->rpo[i];
+        int has_back_edge = 0;
+        for (int p = 0; p < header->npreds; p++) {
+            IrBlock* pred = header->preds[p];
+            if (pred->rpo_index >= 0 && cfg_dominates(header, pred)) {
+                has_back_edge = 1;
+            }
+        }
+        if (!has_back_edge) continue;
+
+        IrLoop* loop = build_loop(fn, header, in_loop);
+        // Il genitore è il ciclo più interno, già noto, che contiene l'header
+        loop->parent = header->loop;
+        loop->depth = loop->parent ? loop->parent->depth + 1 : 1;
+        if (loop->parent) {
+            loop->parent->nchildren++;
+        }
+        // Ogni blocco del corpo ha come ciclo più interno questo, salvo i blocchi di cicli annidati
+        // che verranno sovrascritti più avanti nell'ordine RPO.
+        for (int b = 0; b < loop->nblocks; b++) {
+            loop->blocks[b]->loop = loop;
+            loop->blocks[b]->loop_depth = loop->depth;
+        }
+        fn->loops[fn->nloops++] = loop;
+    }
+    free(in_loop);
+}
+
+void cfg_build(IrFunction* fn) {
+    cfg_free(fn);
+    if (fn->nblocks == 0) return;
+    compute_rpo(fn);
+    compute_dominators(fn);
+    compute_loops(fn);
+}
+
+IrBlock* cfg_loop_preheader(IrLoop* loop) {
+    IrBlock* preheader = NULL;
+    for (int p = 0; p < loop->header->npreds; p++) {
+        IrBlock* pred = loop->header->preds[p];
+        if (cfg_loop_contains(loop, pred)) continue;
+        if (preheader) return NULL;
+        preheader = pred;
+    }
+    if (!preheader || preheader->nsucc != 1) return NULL;
+    return preheader;
+}
@@ -0,0 +1,23 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "ir.h"
+
+// Analisi del grafo di flusso di una funzione IR.
+// cfg_build calcola l'ordine postordine inverso, l'albero dei dominatori (algoritmo di
+// Cooper, Harvey e Kennedy) e i cicli naturali con la loro profondità di annidamento.
+// Va richiamata dopo ogni trasformazione che cambia blocchi o archi: i risultati precedenti vengono scartati.
+void cfg_build(IrFunction* fn);
+void cfg_free(IrFunction* fn);
+
+// Vero se a domina b (ogni cammino dall'ingresso a b passa per a). Un blocco domina se stesso.
+int cfg_dominates(IrBlock* a, IrBlock* b);
+
+// Vero se il blocco appartiene al ciclo (o a uno dei cicli annidati in esso).
+int cfg_loop_contains(IrLoop* loop, IrBlock* block);
+
+// Preheader del ciclo: l'unico predecessore dell'header fuori dal ciclo, se salta solo all'header.
+// NULL se non esiste (più archi entranti, o un predecessore che si dirama anche altrove).
+IrBlock* cfg_loop_preheader(IrLoop* loop);
+
+#endif // CFG_H
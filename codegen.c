@@ -3,259 +3,265 @@
 #include <string.h>
 #include "ast.h"
 #include "codegen.h"
+#include "ir.h"
+#include "lower.h"
+#include "cfg.h"
+#include "ssa.h"
+#include "opt.h"
+#include "x86.h"
 //ao
 // Tabella dei simboli per tenere traccia delle variabili locali.
-// Questa è una lista concatenata semplice che associa il nome della variabile all'offset dello stack.
+// È una tabella hash a indirizzamento aperto (scansione lineare) che associa il nome della variabile al suo slot nel frame.
+// Le voci sono memorizzate direttamente nell'array, senza un nodo allocato per simbolo, e ognuna conserva
+// l'hash del nome (Node.name_hash, calcolato una volta sola dal parser): durante la scansione si confrontano prima gli hash e solo se coincidono si chiama strcmp.
 // Sta cosa serve al compilatore per evitare anche di ridefinire variabili, controllare la semantica del codice e viene gestita dal stm symbol table manager che lavora con l'error handler circa.
-typedef struct Symbol {
+//
+// Gli scope dei blocchi sono gestiti con un registro di annullamento (undo log) sopra l'unica tabella:
+// ogni add_symbol annota cosa c'era prima sotto quel nome, e pop_scope ripercorre all'indietro solo le
+// annotazioni dello scope che si chiude. Aprire e chiudere uno scope costa quindi quanto i nomi dichiarati in esso.
+#define SYMBOL_TABLE_MIN_CAPACITY 64
+
+// Annotazione del registro di annullamento: il nome e il legame che aveva prima della dichiarazione.
+typedef struct {
     char* name;
-    int offset;
-    struct Symbol* next;
-} Symbol;
+    unsigned int hash;
+    int had_previous;   // 0 se il nome non era visibile: alla chiusura dello scope va rimosso
+    int previous_slot;
+    int previous_depth;
+} SymbolUndo;
 
-static Symbol* symbol_table = NULL;
-static int offset_counter = -4; 
-static int label_count = 0;
+static Symbol* symbol_table = NULL;  // voci inline; name == NULL indica una cella libera
+static int symbol_capacity = 0;      // sempre una potenza di 2
+static int symbol_count = 0;
+static int scope_depth = 0;          // 0 = scope della funzione
 
-// Aggiunge un nuovo simbolo alla tabella dei simboli.
-void add_symbol(char* name, int offset) {
-    Symbol* new_symbol = (Symbol*)malloc(sizeof(Symbol));
-    if (!new_symbol) {
-        perror("Errore di allocazione del simbolo");
-        exit(EXIT_FAILURE);
-    }
-    new_symbol->name = strdup(name);
-    new_symbol->offset = offset;
-    new_symbol->next = symbol_table;
-    symbol_table = new_symbol;
-}
+static SymbolUndo* undo_log = NULL;
+static int undo_count = 0;
+static int undo_capacity = 0;
+static int* scope_marks = NULL;      // lunghezza dell'undo log all'apertura di ogni scope
+static int scope_capacity = 0;
 
-// Restituisce l'offset di una variabile dalla tabella dei simboli.
-int get_symbol_offset(char* name) {
-    Symbol* current = symbol_table;
-    while (current) {
-        if (strcmp(current->name, name) == 0) {
-            return current->offset;
+
+// Indice della cella in cui si trova il nome, oppure della cella libera in cui andrebbe inserito.
+static unsigned int find_symbol_index(const char* name, unsigned int hash) {
+    unsigned int mask = (unsigned int)symbol_capacity - 1;
+    unsigned int index = hash & mask;
+    while (symbol_table[index].name) {
+        if (symbol_table[index].hash == hash && strcmp(symbol_table[index].name, name) == 0) {
+            return index;
         }
-        current = current->next;
+        index = (index + 1) & mask;
     }
-    fprintf(stderr, "Errore: variabile '%s' non dichiarata.\n", name);
-    return 0; 
+    return index;
 }
 
-// Libera la memoria allocata per la tabella dei simboli.
-void free_symbol_table() {
-    Symbol* current = symbol_table;
-    while (current) {
-        Symbol* temp = current;
-        current = current->next;
-        free(temp->name);
-        free(temp);
+// Raddoppia la tabella reinserendo le voci esistenti (gli hash sono già noti).
+static void grow_symbol_table(void) {
+    Symbol* old_table = symbol_table;
+    int old_capacity = symbol_capacity;
+
+    symbol_capacity = old_capacity ? old_capacity * 2 : SYMBOL_TABLE_MIN_CAPACITY;
+    symbol_table = (Symbol*)calloc((size_t)symbol_capacity, sizeof(Symbol));
+    if (!symbol_table) {
+        perror("Errore di allocazione della tabella dei simboli");
+        exit(EXIT_FAILURE);
     }
-    symbol_table = NULL;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_table[i].name) {
+            symbol_table[find_symbol_index(old_table[i].name, old_table[i].hash)] = old_table[i];
+        }
+    }
+    free(old_table);
 }
 
-// Prototipi delle funzioni di generazione del codice.
-static void generate_statement(Node* node, FILE* output_file);
-static void generate_statements(List* list, FILE* output_file);
-static void generate_expression(Node* node, FILE* output_file);
-static char* generate_label();
+// Rimuove la voce in posizione index con la cancellazione a spostamento all'indietro
+// (niente lapidi): le voci successive della stessa catena scalano nella cella liberata.
+static void remove_symbol_index(unsigned int index) {
+    unsigned int mask = (unsigned int)symbol_capacity - 1;
+    unsigned int hole = index;
+    unsigned int next = (index + 1) & mask;
 
-// Funzione principale per la generazione del codice assembly.
-void generate_assembly(Node* ast, const char* filename) {
-    FILE* output_file = fopen(filename, "w");
-    if (!output_file) {
-        perror("Impossibile aprire il file di output");
-        return;
+    while (symbol_table[next].name) {
+        unsigned int home = symbol_table[next].hash & mask;
+        // La voce può riempire il buco solo se la sua posizione naturale non sta tra il buco e lei
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            symbol_table[hole] = symbol_table[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
     }
-    
-    // Genera il codice a partire dalla radice dell'AST.
-    generate_statement(ast, output_file);
-    free_symbol_table();
-    fclose(output_file);
+    symbol_table[hole].name = NULL;
+    symbol_count--;
 }
 
-// Genera il codice per una singola espressione.
-static void generate_expression(Node* node, FILE* output_file) {
-    if (!node) return;
-
-    switch (node->type) {
-        case NODE_NUMBER:
-            // Sposta il valore numerico nel registro EAX.
-            fprintf(output_file, "  movl $%d, %%eax\n", node->number_val);
-            break;
-        case NODE_IDENTIFIER:
-            // Sposta il valore della variabile dal suo offset nello stack a EAX.
-            fprintf(output_file, "  movl %d(%%ebp), %%eax\n", get_symbol_offset(node->identifier_name));
-            break;
-        case NODE_PLUS:
-        case NODE_MINUS:
-        case NODE_MULT:
-        case NODE_DIVIDE:
-            // Le espressioni binare vengono risolte valutando il lato sinistro,
-            // mettendo il risultato sullo stack, valutando il lato destro,
-            // e poi eseguendo l'operazione.
-            generate_expression(node->binary_op.left, output_file);  // CORREZIONE: prima sinistra
-            fprintf(output_file, "  pushl %%eax\n");
-            generate_expression(node->binary_op.right, output_file); // poi destra
-            fprintf(output_file, "  popl %%ebx\n");
-            
-            if (node->type == NODE_PLUS) {
-                fprintf(output_file, "  addl %%ebx, %%eax\n");
-            } else if (node->type == NODE_MINUS) {
-                fprintf(output_file, "  subl %%eax, %%ebx\n"); 
-                fprintf(output_file, "  movl %%ebx, %%eax\n");
-            } else if (node->type == NODE_MULT) {
-                fprintf(output_file, "  imull %%ebx, %%eax\n");
-            } else if (node->type == NODE_DIVIDE) {
-                fprintf(output_file, "  movl %%ebx, %%eax\n");  // CORREZIONE: metti il dividendo in EAX
-                fprintf(output_file, "  cdq\n"); 
-                fprintf(output_file, "  popl %%ebx\n");  // divisore in EBX
-                fprintf(output_file, "  idivl %%ebx\n");
-            }
-            break;
-        case NODE_ASSIGN_OP:
-            // Valuta l'espressione a destra e assegna il risultato alla variabile.
-            generate_expression(node->assign_op.expression, output_file);
-            fprintf(output_file, "  movl %%eax, %d(%%ebp)\n", get_symbol_offset(node->assign_op.identifier));
-            break;
-        case NODE_EQUAL_OP:
-        case NODE_NOT_EQUAL_OP:
-        case NODE_LESS_THAN_OP:
-        case NODE_GREATER_THAN_OP:
-            // Genera codice per le operazioni di confronto.
-            generate_expression(node->binary_op.left, output_file);   // CORREZIONE: prima sinistra
-            fprintf(output_file, "  pushl %%eax\n");
-            generate_expression(node->binary_op.right, output_file);  // poi destra
-            fprintf(output_file, "  popl %%ebx\n");
-            fprintf(output_file, "  cmpl %%eax, %%ebx\n");  // CORREZIONE: confronta ebx con eax
-            
-            if (node->type == NODE_EQUAL_OP) {
-                fprintf(output_file, "  sete %%al\n");
-            } else if (node->type == NODE_NOT_EQUAL_OP) {
-                fprintf(output_file, "  setne %%al\n");
-            } else if (node->type == NODE_LESS_THAN_OP) {
-                fprintf(output_file, "  setl %%al\n");
-            } else if (node->type == NODE_GREATER_THAN_OP) {
-                fprintf(output_file, "  setg %%al\n");
-            }
-            // Mette il risultato (0 o 1) nel registro EAX.
-            fprintf(output_file, "  movzbl %%al, %%eax\n");
-            break;
+static void push_undo(SymbolUndo undo) {
+    if (undo_count == undo_capacity) {
+        undo_capacity = undo_capacity ? undo_capacity * 2 : 64;
+        undo_log = (SymbolUndo*)realloc(undo_log, (size_t)undo_capacity * sizeof(SymbolUndo));
+        if (!undo_log) {
+            perror("Errore di allocazione della tabella dei simboli");
+            exit(EXIT_FAILURE);
+        }
     }
+    undo_log[undo_count++] = undo;
 }
 
-// Genera il codice per una singola istruzione.
-static void generate_statement(Node* node, FILE* output_file) {
-    if (!node) return;
+// Aggiunge un nuovo simbolo alla tabella dei simboli nello scope corrente.
+// Se il nome era visibile da uno scope esterno viene oscurato fino alla chiusura dello scope.
+// Il nome non viene copiato: appartiene all'AST, che vive più a lungo della tabella.
+void add_symbol(char* name, unsigned int hash, int slot) {
+    // Fattore di carico massimo 1/2, così le catene di scansione restano corte
+    if ((symbol_count + 1) * 2 > symbol_capacity) {
+        grow_symbol_table();
+    }
+    Symbol* symbol = &symbol_table[find_symbol_index(name, hash)];
+    SymbolUndo undo = { name, hash, 0, -1, 0 };
+    if (symbol->name) {
+        undo.had_previous = 1;
+        undo.previous_slot = symbol->slot;
+        undo.previous_depth = symbol->depth;
+    } else {
+        symbol_count++;
+    }
+    push_undo(undo);
 
-    switch (node->type) {
-        case NODE_PROGRAM:
-            generate_statement(node->program_node.function, output_file);
-            break;
-        case NODE_FUNCTION:
-            fprintf(output_file, ".globl main\n");
-            fprintf(output_file, "main:\n");
-            fprintf(output_file, "  pushl %%ebp\n");
-            fprintf(output_file, "  movl %%esp, %%ebp\n");
+    symbol->name = name;
+    symbol->hash = hash;
+    symbol->slot = slot;
+    symbol->depth = scope_depth;
+}
 
-            // Conta le variabili dichiarate per allocare spazio sullo stack
-            List* decl_list = node->function_def.declarations;
-            int var_space = 0;
-            while(decl_list) {
-                var_space += 4;
-                decl_list = decl_list->next;
-            }
-            if (var_space > 0) {
-                fprintf(output_file, "  subl $%d, %%esp\n", var_space);
-            }
+// Restituisce lo slot di una variabile dalla tabella dei simboli, -1 se non è dichiarata.
+// La segnalazione dell'errore spetta al chiamante (l'analisi semantica).
+int get_symbol_slot(char* name, unsigned int hash) {
+    if (symbol_count == 0) return -1;
+    Symbol* symbol = &symbol_table[find_symbol_index(name, hash)];
+    return symbol->name ? symbol->slot : -1;
+}
 
-            // Aggiungi le dichiarazioni alla tabella dei simboli
-            decl_list = node->function_def.declarations;
-            offset_counter = -4; 
-            while(decl_list) {
-                add_symbol(decl_list->node->declaration_stmt.identifier, offset_counter);
-                offset_counter -= 4; 
-                decl_list = decl_list->next;
-            }
-            
-            // CORREZIONE PRINCIPALE: Genera PRIMA le istruzioni, poi l'epilogo
-            generate_statements(node->function_def.statements, output_file);
+// Vero se il nome è già dichiarato nello scope corrente (una nuova dichiarazione sarebbe un duplicato).
+int is_declared_in_current_scope(char* name, unsigned int hash) {
+    if (symbol_count == 0) return 0;
+    Symbol* symbol = &symbol_table[find_symbol_index(name, hash)];
+    return symbol->name && symbol->depth == scope_depth;
+}
 
-            // Epilogo della funzione (solo se non c'è già un return esplicito)
-            fprintf(output_file, "  movl $0, %%eax\n");
-            fprintf(output_file, "  movl %%ebp, %%esp\n");
-            fprintf(output_file, "  popl %%ebp\n");
-            fprintf(output_file, "  ret\n");
-            break;
-        case NODE_RETURN_STMT:
-            generate_expression(node->return_stmt.expression, output_file);
-            fprintf(output_file, "  movl %%ebp, %%esp\n");
-            fprintf(output_file, "  popl %%ebp\n");
-            fprintf(output_file, "  ret\n");
-            break;
-        case NODE_EXPR_STMT:
-            generate_expression(node->expr_stmt.expression, output_file);
-            break;
-        case NODE_IF_STMT: {
-            char* end_if_label = generate_label();
-            generate_expression(node->if_stmt.condition, output_file);
-            fprintf(output_file, "  cmpl $0, %%eax\n");
-            fprintf(output_file, "  je %s\n", end_if_label);
-            generate_statements(node->if_stmt.if_body, output_file);
-            fprintf(output_file, "%s:\n", end_if_label);
-            free(end_if_label);
-            break;
-        }
-        case NODE_IF_ELSE_STMT: {
-            char* else_label = generate_label();
-            char* end_if_else_label = generate_label();
-            generate_expression(node->if_stmt.condition, output_file);
-            fprintf(output_file, "  cmpl $0, %%eax\n");
-            fprintf(output_file, "  je %s\n", else_label);
-            generate_statements(node->if_stmt.if_body, output_file);
-            fprintf(output_file, "  jmp %s\n", end_if_else_label);
-            fprintf(output_file, "%s:\n", else_label);
-            generate_statements(node->if_stmt.else_body, output_file);
-            fprintf(output_file, "%s:\n", end_if_else_label);
-            free(else_label);
-            free(end_if_else_label);
-            break;
+// Apre uno scope di blocco: basta ricordare la lunghezza attuale dell'undo log.
+void push_scope() {
+    if (scope_depth == scope_capacity) {
+        scope_capacity = scope_capacity ? scope_capacity * 2 : 16;
+        scope_marks = (int*)realloc(scope_marks, (size_t)scope_capacity * sizeof(int));
+        if (!scope_marks) {
+            perror("Errore di allocazione della tabella dei simboli");
+            exit(EXIT_FAILURE);
         }
-        case NODE_WHILE_STMT: {
-            char* start_while_label = generate_label();
-            char* end_while_label = generate_label();
-            fprintf(output_file, "%s:\n", start_while_label);
-            generate_expression(node->while_stmt.condition, output_file);
-            fprintf(output_file, "  cmpl $0, %%eax\n");
-            fprintf(output_file, "  je %s\n", end_while_label);
-            generate_statements(node->while_stmt.while_body, output_file);
-            fprintf(output_file, "  jmp %s\n", start_while_label);
-            fprintf(output_file, "%s:\n", end_while_label);
-            free(start_while_label);
-            free(end_while_label);
-            break;
+    }
+    scope_marks[scope_depth++] = undo_count;
+}
+
+// Chiude lo scope corrente annullando, in ordine inverso, le sole dichiarazioni fatte al suo interno.
+void pop_scope() {
+    int mark = scope_marks[--scope_depth];
+    while (undo_count > mark) {
+        SymbolUndo* undo = &undo_log[--undo_count];
+        unsigned int index = find_symbol_index(undo->name, undo->hash);
+        if (undo->had_previous) {
+            symbol_table[index].slot = undo->previous_slot;
+            symbol_table[index].depth = undo->previous_depth;
+        } else {
+            remove_symbol_index(index);
         }
     }
 }
 
-// Genera il codice per una lista di istruzioni.
-static void generate_statements(List* list, FILE* output_file) {
-    if (!list) return;
-    List* current = list;
-    while(current) {
-        generate_statement(current->node, output_file);
-        current = current->next;
+// Libera la memoria allocata per la tabella dei simboli.
+void free_symbol_table() {
+    free(symbol_table);
+    free(undo_log);
+    free(scope_marks);
+    symbol_table = NULL;
+    undo_log = NULL;
+    scope_marks = NULL;
+    symbol_capacity = 0;
+    symbol_count = 0;
+    undo_count = 0;
+    undo_capacity = 0;
+    scope_capacity = 0;
+    scope_depth = 0;
+}
+
+CodegenOptions codegen_options = { 0, 0, 4 };
+
+// Passi di ottimizzazione sull'IR in forma SSA, nell'ordine in cui vengono applicati.
+static void optimize_function(IrFunction* ir) {
+    if (codegen_options.opt_level >= 1) {
+        opt_fold_constants(ir);
+        opt_simplify(ir);
+        opt_sccp(ir);
+        opt_hoist_invariants(ir);
+        opt_reduce_strength(ir);
+        // Piega i prodotti tra costanti creati nei preheader dalla riduzione della forza
+        opt_fold_constants(ir);
+        opt_unroll_loops(ir, codegen_options.unroll);
+        // I cicli di resto di quelli srotolati del tutto hanno un test ormai costante
+        opt_sccp(ir);
+        // Le copie del corpo srotolato hanno catene i + c1 + c2 da riassociare
+        opt_simplify(ir);
+        opt_value_numbering(ir);
+        opt_rotate_loops(ir);
+        opt_dead_code(ir);
     }
 }
 
-// Genera un'etichetta unica.
-static char* generate_label() {
-    char* label_name = (char*)malloc(16);
-    if (!label_name) {
-        perror("Errore di allocazione");
-        exit(EXIT_FAILURE);
+// Genera il codice di una funzione: abbassamento dell'AST nell'IR in forma SSA (lower.c),
+// analisi del grafo di flusso (cfg.c), ottimizzazioni (opt.h), uscita dalla forma SSA (ssa.c),
+// emissione x86 (x86.c) e ottimizzazione a finestra dell'assembly (peephole.c).
+static void generate_function(Node* function, FILE* output_file) {
+    IrFunction* ir = lower_function(function);
+    cfg_build(ir);
+    // Anche senza ottimizzazioni non si emette il codice che segue un return, né il
+    // "return 0" finale se tutti i cammini restituiscono prima.
+    ir_remove_unreachable_blocks(ir);
+    cfg_build(ir);
+    optimize_function(ir);
+    if (codegen_options.dump_ir) {
+        ir_print_function(ir, stdout);
+    }
+    ssa_destruct(ir);
+    cfg_build(ir);
+    AsmBuffer code;
+    asm_init(&code);
+    X86Allocation allocation = X86_STACK_SLOTS;
+    if (codegen_options.opt_level >= 2) {
+        allocation = X86_GRAPH_COLORING;
+    } else if (codegen_options.opt_level == 1) {
+        allocation = X86_LINEAR_SCAN;
+    }
+    emit_function(ir, &code, allocation);
+    if (codegen_options.opt_level >= 1) {
+        asm_peephole(&code);
     }
-    sprintf(label_name, "L%d", label_count++);
-    return label_name;
+    asm_write(&code, output_file);
+    asm_free(&code);
+    ir_free_function(ir);
+}
+
+// Funzione principale per la generazione del codice assembly.
+void generate_assembly(Node* ast, const char* filename) {
+    FILE* output_file = fopen(filename, "w");
+    if (!output_file) {
+        perror("Impossibile aprire il file di output");
+        return;
+    }
+    
+    // Genera il codice a partire dalla radice dell'AST.
+    // I nomi sono già stati risolti in slot da resolve_names (sema.c).
+    if (ast->type == NODE_PROGRAM) {
+        for (List* current = ast->program_node.functions; current != NULL; current = current->next) {
+            generate_function(current->node, output_file);
+        }
+    } else if (ast->type == NODE_FUNCTION) {
+        generate_function(ast, output_file);
+    }
+    fclose(output_file);
 }
@@ -3,19 +3,31 @@
 
 #include "ast.h" // Per accedere alla struttura dei nodi dell'AST
 
-// Struttura per un singolo elemento della tabella dei simboli
+// Struttura per un singolo elemento della tabella dei simboli (memorizzato inline nella tabella hash)
 typedef struct Symbol {
     char* name;
-    int offset;
-    struct Symbol* next;
+    unsigned int hash;
+    int slot;
+    int depth; // profondità dello scope in cui è dichiarato (0 = corpo della funzione)
 } Symbol;
 
-// Funzioni per la tabella dei simboli
-void add_symbol(char* name, int offset);
-int get_symbol_offset(char* name);
+// Funzioni per la tabella dei simboli (usate dall'analisi semantica in sema.c)
+void add_symbol(char* name, unsigned int hash, int slot);
+int get_symbol_slot(char* name, unsigned int hash); // -1 se la variabile non è dichiarata
+int is_declared_in_current_scope(char* name, unsigned int hash);
+void push_scope();
+void pop_scope();
 void free_symbol_table();
 
+// Opzioni della generazione del codice, impostate da main.c
+typedef struct {
+    int dump_ir;   // stampa l'IR di ogni funzione su stdout (--dump-ir)
+    int opt_level; // livello di ottimizzazione (-O0, -O1, -O2)
+    int unroll;    // copie del corpo per lo srotolamento dei cicli (--unroll=N, 0 o 1 lo disattivano)
+} CodegenOptions;
+
+extern CodegenOptions codegen_options;
+
 // Prototipo della funzione principale di generazione del codice
-void generate_code(Node* ast_root);
 void generate_assembly(Node* ast, const char* filename);
 #endif // CODEGEN_H
@@ -0,0 +1,432 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+#include "regalloc.h"
+
+// Colorazione del grafo delle interferenze con coalescenza iterata (George e Appel, "Iterated
+// Register Coalescing"), con i K = REGALLOC_NREGS registri di regalloc.c come colori.
+// Due registri virtuali interferiscono se uno è definito mentre l'altro è vivo; le copie
+// (IR_COPY, soprattutto quelle dei phi messe da ssa_destruct) non fanno interferire sorgente e
+// destinazione, e se i due nodi si possono unire senza rendere il grafo non colorabile
+// (criterio di Briggs) ricevono lo stesso registro e la copia sparisce.
+//
+// Come nell'algoritmo originale i nodi stanno in liste di lavoro (simplify, freeze, spill) e le
+// copie da esaminare in una lista propria; i nodi passano da una lista all'altra quando cambia il
+// loro grado o si congelano le loro copie, senza riscandire il grafo.
+// Il ciclo alterna semplificazione (via i nodi di grado < K), coalescenza, congelamento delle
+// copie non coalescibili e scelta di un candidato allo spill (costo / grado minimo, con il costo
+// pesato sulla profondità dei cicli come in regalloc.c). Non ci sono nodi precolorati: EAX ed EDX
+// sono fuori dall'allocazione e il linguaggio non ha chiamate.
+// Un nodo che non riceve colore resta nel suo slot: il backend accetta operandi in memoria, quindi
+// non serve riscrivere il programma e ripetere la costruzione del grafo. Le costanti non entrano
+// nel grafo: il backend le rimaterializza come immediati a ogni uso.
+
+typedef enum {
+    COLOR_NONE,         // non partecipa all'allocazione
+    COLOR_SIMPLIFY,     // grado < K, senza copie attive
+    COLOR_FREEZE,       // grado < K, legato a copie
+    COLOR_SPILL,        // grado >= K
+    COLOR_COALESCED,    // unito a un altro nodo (alias)
+    COLOR_SELECT,       // sulla pila di selezione
+    COLOR_COLORED,
+    COLOR_SPILLED
+} ColorState;
+
+typedef enum {
+    MOVE_WORKLIST,      // da esaminare
+    MOVE_ACTIVE,        // non ancora coalescibile
+    MOVE_COALESCED,
+    MOVE_CONSTRAINED,   // sorgente e destinazione interferiscono
+    MOVE_FROZEN         // rinuncia alla coalescenza
+} MoveState;
+
+typedef struct {
+    int* items;
+    int count;
+    int capacity;
+} IntList;
+
+typedef struct {
+    int x;
+    int y;
+    MoveState state;
+} Move;
+
+typedef struct {
+    int n;                  // nodi 0..n-1 (i registri virtuali)
+    unsigned* matrix;       // matrice di adiacenza, un bit per coppia
+    IntList* adjacent;
+    int* degree;
+    ColorState* state;
+    IntList worklist[3];    // nodi COLOR_SIMPLIFY, COLOR_FREEZE e COLOR_SPILL
+    int* position;          // posizione del nodo nella sua lista di lavoro
+    IntList move_worklist;  // copie MOVE_WORKLIST
+    int* alias;
+    int* color;
+    double* cost;
+    char* occurs;           // registri che compaiono in almeno un'istruzione
+    IntList* node_moves;
+    Move* moves;
+    int nmoves;
+    int move_capacity;
+    int* stack;
+    int nstack;
+    int* mark;              // per le unioni di vicini senza duplicati
+    int stamp;
+} Graph;
+
+static void* coloring_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione della colorazione dei registri");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void list_add(IntList* list, int value) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->items = (int*)realloc(list->items, (size_t)list->capacity * sizeof(int));
+        if (!list->items) {
+            perror("Errore di allocazione della colorazione dei registri");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->items[list->count++] = value;
+}
+
+static int bit_test(const unsigned* set, long v) {
+    return (set[v / 32] >> (v % 32)) & 1u;
+}
+
+static void bit_set(unsigned* set, long v) {
+    set[v / 32] |= 1u << (v % 32);
+}
+
+static void bit_clear(unsigned* set, long v) {
+    set[v / 32] &= ~(1u << (v % 32));
+}
+
+static int interfere(Graph* g, int u, int v) {
+    return bit_test(g->matrix, (long)u * g->n + v);
+}
+
+static void add_edge(Graph* g, int u, int v) {
+    if (u == v || interfere(g, u, v)) return;
+    bit_set(g->matrix, (long)u * g->n + v);
+    bit_set(g->matrix, (long)v * g->n + u);
+    list_add(&g->adjacent[u], v);
+    list_add(&g->adjacent[v], u);
+    g->degree[u]++;
+    g->degree[v]++;
+}
+
+// Liste di lavoro dei nodi: simplify, freeze e spill, indicizzate da stato - COLOR_SIMPLIFY.
+static IntList* worklist_of(Graph* g, ColorState state) {
+    if (state == COLOR_SIMPLIFY || state == COLOR_FREEZE || state == COLOR_SPILL) {
+        return &g->worklist[state - COLOR_SIMPLIFY];
+    }
+    return NULL;
+}
+
+// Cambia lo stato del nodo spostandolo tra le liste di lavoro; dalla vecchia lista si toglie
+// scambiandolo con l'ultimo elemento.
+static void set_state(Graph* g, int n, ColorState state) {
+    IntList* from = worklist_of(g, g->state[n]);
+    if (from) {
+        int last = from->items[--from->count];
+        from->items[g->position[n]] = last;
+        g->position[last] = g->position[n];
+    }
+    g->state[n] = state;
+    IntList* to = worklist_of(g, state);
+    if (to) {
+        g->position[n] = to->count;
+        list_add(to, n);
+    }
+}
+
+static int get_alias(Graph* g, int n) {
+    while (g->state[n] == COLOR_COALESCED) n = g->alias[n];
+    return n;
+}
+
+// Vicini ancora nel grafo: esclusi quelli sulla pila e quelli uniti ad altri
+static int is_present(Graph* g, int n) {
+    return g->state[n] != COLOR_SELECT && g->state[n] != COLOR_COALESCED;
+}
+
+static int move_related(Graph* g, int n) {
+    for (int i = 0; i < g->node_moves[n].count; i++) {
+        MoveState state = g->moves[g->node_moves[n].items[i]].state;
+        if (state == MOVE_WORKLIST || state == MOVE_ACTIVE) return 1;
+    }
+    return 0;
+}
+
+static void enable_moves_of(Graph* g, int n) {
+    for (int i = 0; i < g->node_moves[n].count; i++) {
+        Move* move = &g->moves[g->node_moves[n].items[i]];
+        if (move->state == MOVE_ACTIVE) {
+            move->state = MOVE_WORKLIST;
+            list_add(&g->move_worklist, g->node_moves[n].items[i]);
+        }
+    }
+}
+
+static void decrement_degree(Graph* g, int m) {
+    int d = g->degree[m]--;
+    if (d != REGALLOC_NREGS || g->state[m] != COLOR_SPILL) return;
+    enable_moves_of(g, m);
+    for (int i = 0; i < g->adjacent[m].count; i++) {
+        int t = g->adjacent[m].items[i];
+        if (is_present(g, t)) enable_moves_of(g, t);
+    }
+    set_state(g, m, move_related(g, m) ? COLOR_FREEZE : COLOR_SIMPLIFY);
+}
+
+static void add_worklist(Graph* g, int u) {
+    if (g->state[u] == COLOR_FREEZE && !move_related(g, u) && g->degree[u] < REGALLOC_NREGS) {
+        set_state(g, u, COLOR_SIMPLIFY);
+    }
+}
+
+// Criterio di Briggs: il nodo unito ha meno di K vicini di grado significativo.
+static int conservative(Graph* g, int u, int v) {
+    int significant = 0;
+    g->stamp++;
+    int nodes[2] = { u, v };
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < g->adjacent[nodes[k]].count; i++) {
+            int t = g->adjacent[nodes[k]].items[i];
+            if (!is_present(g, t) || g->mark[t] == g->stamp) continue;
+            g->mark[t] = g->stamp;
+            if (g->degree[t] >= REGALLOC_NREGS) significant++;
+        }
+    }
+    return significant < REGALLOC_NREGS;
+}
+
+static void combine(Graph* g, int u, int v) {
+    set_state(g, v, COLOR_COALESCED);
+    g->alias[v] = u;
+    for (int i = 0; i < g->node_moves[v].count; i++) list_add(&g->node_moves[u], g->node_moves[v].items[i]);
+    enable_moves_of(g, v);
+    for (int i = 0; i < g->adjacent[v].count; i++) {
+        int t = g->adjacent[v].items[i];
+        if (!is_present(g, t)) continue;
+        add_edge(g, t, u);
+        decrement_degree(g, t);
+    }
+    if (g->degree[u] >= REGALLOC_NREGS && g->state[u] == COLOR_FREEZE) set_state(g, u, COLOR_SPILL);
+}
+
+static void freeze_moves(Graph* g, int u) {
+    for (int i = 0; i < g->node_moves[u].count; i++) {
+        Move* move = &g->moves[g->node_moves[u].items[i]];
+        if (move->state != MOVE_WORKLIST && move->state != MOVE_ACTIVE) continue;
+        int v = get_alias(g, move->y) == get_alias(g, u) ? get_alias(g, move->x) : get_alias(g, move->y);
+        move->state = MOVE_FROZEN;
+        if (g->state[v] == COLOR_FREEZE && !move_related(g, v) && g->degree[v] < REGALLOC_NREGS) {
+            set_state(g, v, COLOR_SIMPLIFY);
+        }
+    }
+}
+
+static int simplify(Graph* g) {
+    IntList* list = worklist_of(g, COLOR_SIMPLIFY);
+    if (list->count == 0) return 0;
+    int n = list->items[list->count - 1];
+    set_state(g, n, COLOR_SELECT);
+    g->stack[g->nstack++] = n;
+    for (int i = 0; i < g->adjacent[n].count; i++) {
+        int m = g->adjacent[n].items[i];
+        if (is_present(g, m)) decrement_degree(g, m);
+    }
+    return 1;
+}
+
+// Le copie congelate restano nella lista finché non vi si arriva: si saltano.
+static int coalesce(Graph* g) {
+    while (g->move_worklist.count > 0) {
+        Move* move = &g->moves[g->move_worklist.items[--g->move_worklist.count]];
+        if (move->state != MOVE_WORKLIST) continue;
+        int u = get_alias(g, move->x);
+        int v = get_alias(g, move->y);
+        if (u == v) {
+            move->state = MOVE_COALESCED;
+            add_worklist(g, u);
+        } else if (interfere(g, u, v)) {
+            move->state = MOVE_CONSTRAINED;
+            add_worklist(g, u);
+            add_worklist(g, v);
+        } else if (conservative(g, u, v)) {
+            move->state = MOVE_COALESCED;
+            combine(g, u, v);
+            add_worklist(g, u);
+        } else {
+            move->state = MOVE_ACTIVE;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+static int freeze(Graph* g) {
+    IntList* list = worklist_of(g, COLOR_FREEZE);
+    if (list->count == 0) return 0;
+    int u = list->items[list->count - 1];
+    set_state(g, u, COLOR_SIMPLIFY);
+    freeze_moves(g, u);
+    return 1;
+}
+
+static int select_spill(Graph* g) {
+    IntList* list = worklist_of(g, COLOR_SPILL);
+    if (list->count == 0) return 0;
+    int best = list->items[0];
+    for (int i = 1; i < list->count; i++) {
+        int n = list->items[i];
+        if (g->cost[n] / g->degree[n] < g->cost[best] / g->degree[best]) best = n;
+    }
+    set_state(g, best, COLOR_SIMPLIFY);
+    freeze_moves(g, best);
+    return 1;
+}
+
+static void assign_colors(Graph* g) {
+    while (g->nstack > 0) {
+        int n = g->stack[--g->nstack];
+        unsigned ok = (1u << REGALLOC_NREGS) - 1;
+        for (int i = 0; i < g->adjacent[n].count; i++) {
+            int w = get_alias(g, g->adjacent[n].items[i]);
+            if (g->state[w] == COLOR_COLORED) ok &= ~(1u << g->color[w]);
+        }
+        if (!ok) {
+            g->state[n] = COLOR_SPILLED;
+            continue;
+        }
+        int c = 0;
+        while (!(ok & (1u << c))) c++;
+        g->state[n] = COLOR_COLORED;
+        g->color[n] = c;
+    }
+}
+
+static void add_move(Graph* g, int x, int y) {
+    if (g->nmoves == g->move_capacity) {
+        g->move_capacity = g->move_capacity ? g->move_capacity * 2 : 16;
+        g->moves = (Move*)realloc(g->moves, (size_t)g->move_capacity * sizeof(Move));
+        if (!g->moves) {
+            perror("Errore di allocazione della colorazione dei registri");
+            exit(EXIT_FAILURE);
+        }
+    }
+    Move move = { x, y, MOVE_WORKLIST };
+    list_add(&g->node_moves[x], g->nmoves);
+    list_add(&g->node_moves[y], g->nmoves);
+    list_add(&g->move_worklist, g->nmoves);
+    g->moves[g->nmoves++] = move;
+}
+
+// Grafo delle interferenze: si scorre ogni blocco all'indietro partendo dai registri vivi all'uscita.
+static void build(Graph* g, IrFunction* fn, const char* candidate) {
+    int words = fn->nvregs / 32 + 1;
+    unsigned* live_out = regalloc_live_out(fn, words);
+    unsigned* live = (unsigned*)coloring_alloc((size_t)words, sizeof(unsigned));
+    for (int b = 0; b < fn->nblocks; b++) {
+        IrBlock* block = fn->blocks[b];
+        double weight = 1;
+        for (int d = 0; d < block->loop_depth; d++) weight *= 10;
+        memcpy(live, &live_out[b * words], (size_t)words * sizeof(unsigned));
+        for (int j = block->ninsns - 1; j >= 0; j--) {
+            IrInsn* insn = &block->insns[j];
+            int count = ir_operand_count(insn);
+            int is_move = insn->op == IR_COPY && candidate[insn->dst] && candidate[insn->a];
+            if (is_move) {
+                bit_clear(live, insn->a);
+                add_move(g, insn->dst, insn->a);
+            }
+            g->occurs[insn->dst] = 1;
+            if (insn->dst && candidate[insn->dst]) {
+                for (int w = 0; w < words; w++) {
+                    for (unsigned bits = live[w]; bits; bits &= bits - 1) {
+                        int v = w * 32 + __builtin_ctz(bits);
+                        if (candidate[v]) add_edge(g, insn->dst, v);
+                    }
+                }
+                g->cost[insn->dst] += weight;
+            }
+            if (insn->dst) bit_clear(live, insn->dst);
+            for (int k = 0; k < count; k++) {
+                int v = *ir_operand(insn, k);
+                bit_set(live, v);
+                g->occurs[v] = 1;
+                if (candidate[v]) g->cost[v] += weight;
+            }
+        }
+    }
+    free(live);
+    free(live_out);
+}
+
+int* regalloc_graph_coloring(IrFunction* fn, const char* candidate) {
+    Graph g;
+    memset(&g, 0, sizeof(g));
+    g.n = fn->nvregs + 1;
+    g.matrix = (unsigned*)coloring_alloc((size_t)((long)g.n * g.n / 32 + 1), sizeof(unsigned));
+    g.adjacent = (IntList*)coloring_alloc((size_t)g.n, sizeof(IntList));
+    g.node_moves = (IntList*)coloring_alloc((size_t)g.n, sizeof(IntList));
+    g.degree = (int*)coloring_alloc((size_t)g.n, sizeof(int));
+    g.state = (ColorState*)coloring_alloc((size_t)g.n, sizeof(ColorState));
+    g.alias = (int*)coloring_alloc((size_t)g.n, sizeof(int));
+    g.color = (int*)coloring_alloc((size_t)g.n, sizeof(int));
+    g.cost = (double*)coloring_alloc((size_t)g.n, sizeof(double));
+    g.occurs = (char*)coloring_alloc((size_t)g.n, 1);
+    g.stack = (int*)coloring_alloc((size_t)g.n, sizeof(int));
+    g.mark = (int*)coloring_alloc((size_t)g.n, sizeof(int));
+    g.position = (int*)coloring_alloc((size_t)g.n, sizeof(int));
+
+    build(&g, fn, candidate);
+    for (int n = 1; n < g.n; n++) {
+        // I registri spariti dal codice restano fuori: un colore segnerebbe il registro come usato
+        if (!candidate[n] || !g.occurs[n]) continue;
+        if (g.degree[n] >= REGALLOC_NREGS) {
+            set_state(&g, n, COLOR_SPILL);
+        } else {
+            set_state(&g, n, move_related(&g, n) ? COLOR_FREEZE : COLOR_SIMPLIFY);
+        }
+    }
+    while (simplify(&g) || coalesce(&g) || freeze(&g) || select_spill(&g)) {
+    }
+    assign_colors(&g);
+
+    int* assignment = (int*)coloring_alloc((size_t)g.n, sizeof(int));
+    for (int n = 0; n < g.n; n++) {
+        int a = candidate[n] ? get_alias(&g, n) : n;
+        assignment[n] = candidate[n] && g.state[a] == COLOR_COLORED ? g.color[a] : -1;
+    }
+
+    free(g.matrix);
+    for (int n = 0; n < g.n; n++) {
+        free(g.adjacent[n].items);
+        free(g.node_moves[n].items);
+    }
+    free(g.adjacent);
+    free(g.node_moves);
+    free(g.degree);
+    free(g.state);
+    free(g.alias);
+    free(g.color);
+    free(g.cost);
+    free(g.occurs);
+    free(g.moves);
+    free(g.stack);
+    free(g.mark);
+    free(g.position);
+    for (int k = 0; k < 3; k++) free(g.worklist[k].items);
+    free(g.move_worklist.items);
+    return assignment;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "cfg.h"
+#include "opt.h"
+
+// Eliminazione del codice morto.
+// Si parte dalle istruzioni che hanno effetti visibili (salti, return) e si marcano vive,
+// risalendo le definizioni in forma SSA, tutte le istruzioni da cui dipendono i loro operandi.
+// Quelle rimaste non marcate non contribuiscono al risultato e vengono tolte. Partire dalle radici,
+// invece di togliere i registri con zero usi, elimina anche i cicli di phi morti (una variabile
+// aggiornata in un ciclo e mai letta dopo).
+// Infine i blocchi rimasti in fila senza diramazioni (un salto verso un blocco che ha solo quel
+// predecessore) vengono fusi, così spariscono anche i blocchi svuotati.
+
+typedef struct {
+    IrBlock* block;
+    int index;
+} DceDef;
+
+// Una divisione può fermare il programma (divisione per zero, INT_MIN / -1): si può togliere
+// solo se il divisore è una costante che esclude entrambi i casi.
+static int is_safe_divisor(DceDef* defs, int vreg) {
+    DceDef* def = &defs[vreg];
+    if (!def->block) return 0;
+    IrInsn* insn = &def->block->insns[def->index];
+    return insn->op == IR_CONST && insn->imm != 0 && insn->imm != -1;
+}
+
+static int has_side_effects(DceDef* defs, IrInsn* insn) {
+    switch (insn->op) {
+        case IR_JUMP:
+        case IR_BRANCH:
+        case IR_RET:
+            return 1;
+        case IR_DIV:
+            return !is_safe_divisor(defs, insn->b);
+        default:
+            return 0;
+    }
+}
+
+static void mark_live(DceDef* defs, char* live, int* work, int* nwork, IrInsn* insn) {
+    int n = ir_operand_count(insn);
+    for (int k = 0; k < n; k++) {
+        int v = *ir_operand(insn, k);
+        if (!live[v] && defs[v].block) {
+            live[v] = 1;
+            work[(*nwork)++] = v;
+        }
+    }
+}
+
+// Accoda a block il suo unico successore next (di cui block è l'unico predecessore).
+// Gli eventuali phi di next hanno un solo argomento e diventano copie.
+static void merge_into(IrFunction* fn, IrBlock* block, IrBlock* next) {
+    block->ninsns--;    // il salto verso next
+    for (int j = 0; j < next->ninsns; j++) {
+        IrInsn* insn = &next->insns[j];
+        if (insn->op == IR_PHI) {
+            ir_append(block, IR_COPY, insn->dst, insn->args[0], 0, 0);
+            free(insn->args);
+        } else {
+            *ir_append(block, insn->op, insn->dst, insn->a, insn->b, insn->imm) = *insn;
+        }
+    }
+    block->nsucc = next->nsucc;
+    for (int s = 0; s < next->nsucc; s++) {
+        IrBlock* succ = next->succ[s];
+        block->succ[s] = succ;
+        for (int p = 0; p < succ->npreds; p++) {
+            if (succ->preds[p] == next) succ->preds[p] = block;
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < fn->nblocks; i++) {
+        if (fn->blocks[i] != next) fn->blocks[kept++] = fn->blocks[i];
+    }
+    fn->nblocks = kept;
+    free(next->insns);
+    free(next->preds);
+    free(next->dom_children);
+    free(next);
+}
+
+static void merge_blocks(IrFunction* fn) {
+    int merged = 0;
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        IrInsn* last = ir_terminator(block);
+        while (last && last->op == IR_JUMP) {
+            IrBlock* next = block->succ[0];
+            if (next == block || next == fn->blocks[0] || next->npreds != 1) break;
+            merge_into(fn, block, next);
+            merged = 1;
+            // next poteva precedere block nell'ordine dei blocchi
+            if (fn->blocks[i] != block) i--;
+            last = ir_terminator(block);
+        }
+    }
+    if (merged) {
+        cfg_build(fn);
+        opt_propagate_copies(fn);
+    }
+}
+
+void opt_dead_code(IrFunction* fn) {
+    DceDef* defs = (DceDef*)calloc((size_t)fn->nvregs + 1, sizeof(DceDef));
+    char* live = (char*)calloc((size_t)fn->nvregs + 1, 1);
+    int* work = (int*)malloc(((size_t)fn->nvregs + 1) * sizeof(int));
+    if (!defs || !live || !work) {
+        perror("Errore di allocazione dell'eliminazione del codice morto");
+        exit(EXIT_FAILURE);
+    }
+    int nwork = 0;
+
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            if (block->insns[j].dst) {
+                defs[block->insns[j].dst].block = block;
+                defs[block->insns[j].dst].index = j;
+            }
+        }
+    }
+
+    // Radici: le istruzioni con effetti; i loro registri restano definiti anche se inutilizzati.
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            if (!has_side_effects(defs, insn)) continue;
+            if (insn->dst && !live[insn->dst]) live[insn->dst] = 1;
+            mark_live(defs, live, work, &nwork, insn);
+        }
+    }
+    while (nwork > 0) {
+        DceDef* def = &defs[work[--nwork]];
+        mark_live(defs, live, work, &nwork, &def->block->insns[def->index]);
+    }
+
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; ) {
+            IrInsn* insn = &block->insns[j];
+            if (insn->dst && !live[insn->dst]) {
+                ir_remove(block, j);
+            } else {
+                j++;
+            }
+        }
+    }
+
+    free(defs);
+    free(live);
+    free(work);
+    merge_blocks(fn);
+}
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "opt.h"
+
+// Piegatura e propagazione delle costanti.
+// Grazie alla forma SSA ogni variabile locale assegnata con una costante è un registro definito
+// da un IR_CONST: basta visitare le istruzioni e sostituire con un IR_CONST ogni operazione i cui
+// operandi sono tutti costanti. I phi con argomenti tutti uguali alla stessa costante diventano
+// anch'essi costanti; poiché i phi degli header dei cicli dipendono da valori calcolati più avanti,
+// si ripete la visita finché qualcosa cambia.
+
+typedef struct {
+    char* known;
+    int* value;
+} ConstState;
+
+static int is_known(ConstState* state, int vreg, int* value) {
+    if (!state->known[vreg]) return 0;
+    *value = state->value[vreg];
+    return 1;
+}
+
+static void make_constant(ConstState* state, IrInsn* insn, int value) {
+    free(insn->args);
+    insn->args = NULL;
+    insn->nargs = 0;
+    insn->op = IR_CONST;
+    insn->a = 0;
+    insn->b = 0;
+    insn->imm = value;
+    state->known[insn->dst] = 1;
+    state->value[insn->dst] = value;
+}
+
+// Restituisce 1 se l'istruzione è diventata (o era già) una costante nota.
+static int fold_insn(ConstState* state, IrBlock* block, int index) {
+    IrInsn* insn = &block->insns[index];
+    int a, b, result;
+
+    if (insn->dst && state->known[insn->dst]) return 0;
+
+    switch (insn->op) {
+        case IR_CONST:
+            state->known[insn->dst] = 1;
+            state->value[insn->dst] = insn->imm;
+            return 1;
+        case IR_COPY:
+            if (!is_known(state, insn->a, &a)) return 0;
+            make_constant(state, insn, a);
+            return 1;
+        case IR_PHI: {
+            if (insn->nargs == 0 || !is_known(state, insn->args[0], &a)) return 0;
+            for (int i = 1; i < insn->nargs; i++) {
+                if (!is_known(state, insn->args[i], &b) || b != a) return 0;
+            }
+            make_constant(state, insn, a);
+            ir_move_after_phis(block, index);
+            return 1;
+        }
+        default:
+            if (!ir_is_binary(insn->op)) return 0;
+            if (!is_known(state, insn->a, &a) || !is_known(state, insn->b, &b)) return 0;
+            if (!ir_eval_binary(insn->op, a, b, &result)) return 0;
+            make_constant(state, insn, result);
+            return 1;
+    }
+}
+
+// Le costanti rimaste senza usi (gli operandi delle operazioni piegate) vengono eliminate.
+static void remove_unused_constants(IrFunction* fn) {
+    int* uses = ir_use_counts(fn);
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; ) {
+            if (block->insns[j].op == IR_CONST && uses[block->insns[j].dst] == 0) {
+                ir_remove(block, j);
+            } else {
+                j++;
+            }
+        }
+    }
+    free(uses);
+}
+
+void opt_fold_constants(IrFunction* fn) {
+    ConstState state;
+    state.known = (char*)calloc((size_t)fn->nvregs + 1, 1);
+    state.value = (int*)calloc((size_t)fn->nvregs + 1, sizeof(int));
+    if (!state.known || !state.value) {
+        perror("Errore di allocazione della piegatura delle costanti");
+        exit(EXIT_FAILURE);
+    }
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < fn->nrpo; i++) {
+            IrBlock* block = fn->rpo[i];
+            for (int j = 0; j < block->ninsns; j++) {
+                // Un phi spostato dopo gli altri phi lascia al suo posto il phi successivo:
+                // si riesamina la stessa posizione.
+                IrOp op = block->insns[j].op;
+                if (fold_insn(&state, block, j)) {
+                    if (op != IR_CONST) changed = 1;
+                    if (op == IR_PHI && block->insns[j].op == IR_PHI) j--;
+                }
+            }
+        }
+    }
+
+    remove_unused_constants(fn);
+    free(state.known);
+    free(state.value);
+}
+
+// Propagazione delle copie: in forma SSA "dst = copy a" si elimina facendo usare a al posto di dst.
+// Lo stesso vale per i phi banali (tutti gli argomenti uguali, a parte se stesso), che restano
+// per esempio quando altri passi tolgono dei predecessori a un blocco.
+static int resolve_alias(int* alias, int vreg) {
+    while (alias[vreg]) vreg = alias[vreg];
+    return vreg;
+}
+
+void opt_propagate_copies(IrFunction* fn) {
+    int* alias = (int*)calloc((size_t)fn->nvregs + 1, sizeof(int));
+    if (!alias) {
+        perror("Errore di allocazione della propagazione delle copie");
+        exit(EXIT_FAILURE);
+    }
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < fn->nblocks; i++) {
+            IrBlock* block = fn->blocks[i];
+            for (int j = 0; j < block->ninsns; j++) {
+                IrInsn* insn = &block->insns[j];
+                if (!insn->dst || alias[insn->dst]) continue;
+                int same = 0;
+                if (insn->op == IR_COPY) {
+                    same = resolve_alias(alias, insn->a);
+                } else if (insn->op == IR_PHI) {
+                    for (int k = 0; k < insn->nargs; k++) {
+                        int arg = resolve_alias(alias, insn->args[k]);
+                        if (arg == same || arg == insn->dst) continue;
+                        if (same) {
+                            same = -1;
+                            break;
+                        }
+                        same = arg;
+                    }
+                }
+                if (same > 0 && same != insn->dst) {
+                    alias[insn->dst] = same;
+                    changed = 1;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; ) {
+            IrInsn* insn = &block->insns[j];
+            if (insn->dst && alias[insn->dst]) {
+                ir_remove(block, j);
+                continue;
+            }
+            int n = ir_operand_count(insn);
+            for (int k = 0; k < n; k++) {
+                int* operand = ir_operand(insn, k);
+                *operand = resolve_alias(alias, *operand);
+            }
+            j++;
+        }
+    }
+    free(alias);
+}
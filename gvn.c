@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "opt.h"
+
+// Numerazione globale dei valori (eliminazione delle sottoespressioni comuni).
+// In forma SSA due istruzioni con la stessa operazione e gli stessi operandi calcolano lo stesso
+// valore; se la prima domina la seconda, la seconda si può togliere facendo usare la prima.
+// Si visita l'albero dei dominatori in profondità tenendo una tabella hash delle espressioni già
+// calcolate lungo il cammino dall'ingresso: entrando in un blocco si aggiungono le sue, uscendone
+// si tolgono, come per gli scope della tabella dei simboli.
+// Le operazioni commutative e i confronti vengono normalizzati (a > b diventa b < a) in modo
+// che a*b e b*a abbiano lo stesso numero. Anche le costanti vengono numerate: ogni valore
+// costante viene materializzato una sola volta per cammino di dominanza.
+
+typedef struct {
+    IrOp op;
+    int a;
+    int b;
+    int imm;
+    int vreg;   // 0 indica una cella libera
+} GvnEntry;
+
+typedef struct {
+    GvnEntry* table;
+    unsigned int mask;
+    unsigned int* added;    // celle occupate, nell'ordine di inserimento
+    int nadded;
+    int* alias;             // registro eliminato -> registro che ne prende il posto
+} GvnState;
+
+static void* gvn_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione della numerazione dei valori");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static int resolve(GvnState* state, int vreg) {
+    while (state->alias[vreg]) vreg = state->alias[vreg];
+    return vreg;
+}
+
+static int is_commutative(IrOp op) {
+    return op == IR_ADD || op == IR_MUL || op == IR_EQ || op == IR_NE;
+}
+
+// Chiave dell'istruzione in forma normale; restituisce 0 se l'istruzione non va numerata.
+static int make_key(GvnState* state, IrInsn* insn, GvnEntry* key) {
+    key->op = insn->op;
+    key->a = 0;
+    key->b = 0;
+    key->imm = 0;
+    key->vreg = 0;
+    if (insn->op == IR_CONST) {
+        key->imm = insn->imm;
+        return 1;
+    }
+    if (!ir_is_binary(insn->op)) return 0;
+    key->a = resolve(state, insn->a);
+    key->b = resolve(state, insn->b);
+    if (key->op == IR_GT) {
+        int t = key->a;
+        key->op = IR_LT;
+        key->a = key->b;
+        key->b = t;
+    } else if (is_commutative(key->op) && key->a > key->b) {
+        int t = key->a;
+        key->a = key->b;
+        key->b = t;
+    }
+    return 1;
+}
+
+static unsigned int key_hash(GvnEntry* key) {
+    unsigned int h = 2166136261u;
+    h = (h ^ (unsigned int)key->op) * 16777619u;
+    h = (h ^ (unsigned int)key->a) * 16777619u;
+    h = (h ^ (unsigned int)key->b) * 16777619u;
+    h = (h ^ (unsigned int)key->imm) * 16777619u;
+    return h;
+}
+
+// Cerca la chiave: restituisce il registro che la calcola già, oppure la inserisce con vreg e restituisce 0.
+static int lookup_or_insert(GvnState* state, GvnEntry* key, int vreg) {
+    unsigned int index = key_hash(key) & state->mask;
+    while (state->table[index].vreg) {
+        GvnEntry* entry = &state->table[index];
+        if (entry->op == key->op && entry->a == key->a && entry->b == key->b && entry->imm == key->imm) {
+            return entry->vreg;
+        }
+        index = (index + 1) & state->mask;
+    }
+    state->table[index] = *key;
+    state->table[index].vreg = vreg;
+    state->added[state->nadded++] = index;
+    return 0;
+}
+
+// Toglie le voci inserite dopo mark. Le voci escono in ordine inverso di inserimento, quindi
+// nessuna voce rimasta ha mai scandito le celle liberate: basta svuotarle, senza spostamenti.
+static void drop_entries(GvnState* state, int mark) {
+    while (state->nadded > mark) {
+        state->table[state->added[--state->nadded]].vreg = 0;
+    }
+}
+
+// Due phi dello stesso blocco con gli stessi argomenti sono lo stesso valore.
+static int find_equal_phi(GvnState* state, IrBlock* block, int index) {
+    IrInsn* phi = &block->insns[index];
+    for (int j = 0; j < index; j++) {
+        IrInsn* other = &block->insns[j];
+        int same = 1;
+        for (int k = 0; k < phi->nargs && same; k++) {
+            same = resolve(state, phi->args[k]) == resolve(state, other->args[k]);
+        }
+        if (same) return other->dst;
+    }
+    return 0;
+}
+
+static void number_block(GvnState* state, IrBlock* block) {
+    for (int j = 0; j < block->ninsns; ) {
+        IrInsn* insn = &block->insns[j];
+        GvnEntry key;
+        int existing = 0;
+        if (insn->op == IR_PHI) {
+            existing = find_equal_phi(state, block, j);
+        } else if (insn->op == IR_COPY) {
+            existing = resolve(state, insn->a);
+        } else if (make_key(state, insn, &key)) {
+            existing = lookup_or_insert(state, &key, insn->dst);
+        }
+        if (existing) {
+            state->alias[insn->dst] = existing;
+            ir_remove(block, j);
+        } else {
+            j++;
+        }
+    }
+}
+
+void opt_value_numbering(IrFunction* fn) {
+    if (fn->nrpo == 0) return;
+
+    int ninsns = 0;
+    for (int i = 0; i < fn->nblocks; i++) ninsns += fn->blocks[i]->ninsns;
+    unsigned int capacity = 16;
+    while (capacity < (unsigned int)ninsns * 2) capacity *= 2;
+
+    GvnState state;
+    state.table = (GvnEntry*)gvn_alloc(capacity, sizeof(GvnEntry));
+    state.mask = capacity - 1;
+    state.added = (unsigned int*)gvn_alloc((size_t)ninsns, sizeof(unsigned int));
+    state.nadded = 0;
+    state.alias = (int*)gvn_alloc((size_t)fn->nvregs + 1, sizeof(int));
+
+    // Visita in profondità dell'albero dei dominatori, come la numerazione pre/post di cfg.c
+    IrBlock** stack = (IrBlock**)gvn_alloc((size_t)fn->nrpo, sizeof(IrBlock*));
+    int* next_child = (int*)gvn_alloc((size_t)fn->nrpo, sizeof(int));
+    int* marks = (int*)gvn_alloc((size_t)fn->nrpo, sizeof(int));
+    int top = 0;
+    marks[top] = state.nadded;
+    number_block(&state, fn->rpo[0]);
+    stack[top] = fn->rpo[0];
+    next_child[top++] = 0;
+    while (top > 0) {
+        IrBlock* block = stack[top - 1];
+        if (next_child[top - 1] < block->ndom_children) {
+            IrBlock* child = block->dom_children[next_child[top - 1]++];
+            marks[top] = state.nadded;
+            number_block(&state, child);
+            stack[top] = child;
+            next_child[top++] = 0;
+        } else {
+            drop_entries(&state, marks[--top]);
+        }
+    }
+
+    // Gli argomenti dei phi possono arrivare da blocchi visitati dopo: si riscrivono tutti alla fine
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            int n = ir_operand_count(&block->insns[j]);
+            for (int k = 0; k < n; k++) {
+                int* operand = ir_operand(&block->insns[j], k);
+                *operand = resolve(&state, *operand);
+            }
+        }
+    }
+
+    free(stack);
+    free(next_child);
+    free(marks);
+    free(state.table);
+    free(state.added);
+    free(state.alias);
+}
@@ -0,0 +1,431 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+#include "cfg.h"
+
+// Rialloca un array dinamico raddoppiandone la capacità quando è pieno.
+static void* grow_array(void* array, int count, int* capacity, size_t elem_size) {
+    if (count < *capacity) return array;
+    *capacity = *capacity ? *capacity * 2 : 8;
+    array = realloc(array, (size_t)*capacity * elem_size);
+    if (!array) {
+        perror("Errore di allocazione dell'IR");
+        exit(EXIT_FAILURE);
+    }
+    return array;
+}
+
+IrFunction* ir_new_function(const char* name) {
+    IrFunction* fn = (IrFunction*)calloc(1, sizeof(IrFunction));
+    if (!fn) {
+        perror("Errore di allocazione dell'IR");
+        exit(EXIT_FAILURE);
+    }
+    fn->name = strdup(name);
+    return fn;
+}
+
+// Crea un blocco vuoto. Il blocco entra nell'ordine di emissione solo con ir_place_block,
+// così chi abbassa l'AST può creare in anticipo i blocchi di uscita e piazzarli dopo il corpo.
+IrBlock* ir_new_block(IrFunction* fn) {
+    IrBlock* block = (IrBlock*)calloc(1, sizeof(IrBlock));
+    if (!block) {
+        perror("Errore di allocazione dell'IR");
+        exit(EXIT_FAILURE);
+    }
+    block->id = fn->next_block_id++;
+    block->rpo_index = -1;
+    return block;
+}
+
+void ir_place_block(IrFunction* fn, IrBlock* block) {
+    fn->blocks = (IrBlock**)grow_array(fn->blocks, fn->nblocks, &fn->block_cap, sizeof(IrBlock*));
+    fn->blocks[fn->nblocks++] = block;
+}
+
+int ir_new_vreg(IrFunction* fn) {
+    return ++fn->nvregs;
+}
+
+// Aggiunge un'istruzione in coda al blocco. Il puntatore restituito resta valido
+// solo fino alla prossima aggiunta nello stesso blocco.
+IrInsn* ir_append(IrBlock* block, IrOp op, int dst, int a, int b, int imm) {
+    block->insns = (IrInsn*)grow_array(block->insns, block->ninsns, &block->insn_cap, sizeof(IrInsn));
+    IrInsn* insn = &block->insns[block->ninsns++];
+    insn->op = op;
+    insn->dst = dst;
+    insn->a = a;
+    insn->b = b;
+    insn->imm = imm;
+    insn->args = NULL;
+    insn->nargs = 0;
+    return insn;
+}
+
+// Inserisce un'istruzione in posizione index, spostando in avanti le successive.
+IrInsn* ir_insert(IrBlock* block, int index, IrOp op, int dst, int a, int b, int imm) {
+    ir_append(block, op, dst, a, b, imm);
+    IrInsn inserted = block->insns[block->ninsns - 1];
+    memmove(&block->insns[index + 1], &block->insns[index], sizeof(IrInsn) * (size_t)(block->ninsns - 1 - index));
+    block->insns[index] = inserted;
+    return &block->insns[index];
+}
+
+// Elimina l'istruzione in posizione index (liberando gli argomenti di un phi).
+void ir_remove(IrBlock* block, int index) {
+    free(block->insns[index].args);
+    memmove(&block->insns[index], &block->insns[index + 1], sizeof(IrInsn) * (size_t)(block->ninsns - 1 - index));
+    block->ninsns--;
+}
+
+// Aggiunge un'istruzione che produce un valore in un nuovo registro virtuale e lo restituisce.
+int ir_emit(IrFunction* fn, IrBlock* block, IrOp op, int a, int b, int imm) {
+    int dst = ir_new_vreg(fn);
+    ir_append(block, op, dst, a, b, imm);
+    return dst;
+}
+
+static void add_edge(IrBlock* from, IrBlock* to) {
+    from->succ[from->nsucc++] = to;
+    to->preds = (IrBlock**)grow_array(to->preds, to->npreds, &to->pred_cap, sizeof(IrBlock*));
+    to->preds[to->npreds++] = from;
+}
+
+void ir_jump(IrBlock* block, IrBlock* target) {
+    ir_append(block, IR_JUMP, 0, 0, 0, 0);
+    add_edge(block, target);
+}
+
+void ir_branch(IrBlock* block, int cond, IrBlock* if_true, IrBlock* if_false) {
+    ir_append(block, IR_BRANCH, 0, cond, 0, 0);
+    add_edge(block, if_true);
+    add_edge(block, if_false);
+}
+
+void ir_ret(IrBlock* block, int value) {
+    ir_append(block, IR_RET, 0, value, 0, 0);
+}
+
+// Spezza l'arco from -> from->succ[succ_index] con un nuovo blocco che contiene solo un salto.
+// Il nuovo blocco prende il posto di from tra i predecessori del successore, quindi gli argomenti
+// dei phi restano allineati; nell'ordine di emissione va subito dopo from.
+IrBlock* ir_split_edge(IrFunction* fn, IrBlock* from, int succ_index) {
+    IrBlock* to = from->succ[succ_index];
+    IrBlock* middle = ir_new_block(fn);
+
+    ir_append(middle, IR_JUMP, 0, 0, 0, 0);
+    middle->succ[middle->nsucc++] = to;
+    for (int p = 0; p < to->npreds; p++) {
+        if (to->preds[p] == from) {
+            to->preds[p] = middle;
+            break;
+        }
+    }
+    from->succ[succ_index] = middle;
+    middle->preds = (IrBlock**)grow_array(middle->preds, middle->npreds, &middle->pred_cap, sizeof(IrBlock*));
+    middle->preds[middle->npreds++] = from;
+
+    ir_place_block_after(fn, middle, from);
+    return middle;
+}
+
+// Come ir_place_block, ma nell'ordine di emissione il blocco va subito dopo after.
+void ir_place_block_after(IrFunction* fn, IrBlock* block, IrBlock* after) {
+    ir_place_block(fn, block);
+    int position = 0;
+    while (fn->blocks[position] != after) position++;
+    memmove(&fn->blocks[position + 2], &fn->blocks[position + 1], sizeof(IrBlock*) * (size_t)(fn->nblocks - 2 - position));
+    fn->blocks[position + 1] = block;
+}
+
+// Varianti di ir_jump e ir_branch per chi ridisegna il grafo: block prende il posto di old_pred
+// tra i predecessori di target (per il branch, if_false), quindi gli argomenti dei phi restano allineati.
+static void replace_pred(IrBlock* block, IrBlock* target, IrBlock* old_pred) {
+    block->succ[block->nsucc++] = target;
+    for (int p = 0; p < target->npreds; p++) {
+        if (target->preds[p] == old_pred) {
+            target->preds[p] = block;
+            return;
+        }
+    }
+}
+
+void ir_jump_replacing(IrBlock* block, IrBlock* target, IrBlock* old_pred) {
+    ir_append(block, IR_JUMP, 0, 0, 0, 0);
+    replace_pred(block, target, old_pred);
+}
+
+void ir_branch_replacing(IrBlock* block, int cond, IrBlock* if_true, IrBlock* if_false, IrBlock* old_pred) {
+    ir_append(block, IR_BRANCH, 0, cond, 0, 0);
+    add_edge(block, if_true);
+    replace_pred(block, if_false, old_pred);
+}
+
+// Toglie il terminatore del blocco per poterne aggiungere uno diverso. I successori lo tengono
+// ancora tra i predecessori: il chiamante deve mettere un altro blocco al suo posto con
+// ir_jump_replacing o ir_branch_replacing.
+void ir_remove_terminator(IrBlock* block) {
+    block->nsucc = 0;
+    ir_remove(block, block->ninsns - 1);
+}
+
+// Toglie il predecessore index, insieme all'argomento corrispondente di ogni phi del blocco.
+void ir_remove_pred(IrBlock* block, int index) {
+    for (int i = 0; i < block->ninsns && block->insns[i].op == IR_PHI; i++) {
+        IrInsn* phi = &block->insns[i];
+        memmove(&phi->args[index], &phi->args[index + 1], sizeof(int) * (size_t)(phi->nargs - 1 - index));
+        phi->nargs--;
+    }
+    memmove(&block->preds[index], &block->preds[index + 1], sizeof(IrBlock*) * (size_t)(block->npreds - 1 - index));
+    block->npreds--;
+}
+
+static void remove_edge_to(IrBlock* from, IrBlock* to) {
+    for (int p = 0; p < to->npreds; p++) {
+        if (to->preds[p] == from) {
+            ir_remove_pred(to, p);
+            return;
+        }
+    }
+}
+
+// Trasforma il branch finale del blocco in un salto incondizionato verso succ[keep]
+// (la condizione è nota), togliendo l'arco verso l'altro successore.
+void ir_branch_to_jump(IrBlock* block, int keep) {
+    IrInsn* branch = ir_terminator(block);
+    IrBlock* kept = block->succ[keep];
+    remove_edge_to(block, block->succ[1 - keep]);
+    branch->op = IR_JUMP;
+    branch->a = 0;
+    block->succ[0] = kept;
+    block->succ[1] = NULL;
+    block->nsucc = 1;
+}
+
+// Elimina i blocchi non raggiungibili dall'ingresso (rpo_index < 0 secondo l'ultimo cfg_build)
+// e i loro archi verso i blocchi raggiungibili. Dopo va richiamato cfg_build.
+void ir_remove_unreachable_blocks(IrFunction* fn) {
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        if (block->rpo_index >= 0) continue;
+        for (int s = 0; s < block->nsucc; s++) {
+            if (block->succ[s]->rpo_index >= 0) {
+                remove_edge_to(block, block->succ[s]);
+            }
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        if (block->rpo_index >= 0) {
+            fn->blocks[kept++] = block;
+            continue;
+        }
+        for (int j = 0; j < block->ninsns; j++) {
+            free(block->insns[j].args);
+        }
+        free(block->insns);
+        free(block->preds);
+        free(block->dom_children);
+        free(block);
+    }
+    fn->nblocks = kept;
+}
+
+IrInsn* ir_terminator(IrBlock* block) {
+    if (block->ninsns == 0) return NULL;
+    IrInsn* last = &block->insns[block->ninsns - 1];
+    if (last->op == IR_JUMP || last->op == IR_BRANCH || last->op == IR_RET) {
+        return last;
+    }
+    return NULL;
+}
+
+int ir_is_terminated(IrBlock* block) {
+    return ir_terminator(block) != NULL;
+}
+
+int ir_is_binary(IrOp op) {
+    switch (op) {
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_EQ:
+        case IR_NE:
+        case IR_LT:
+        case IR_GT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Operandi letti da un'istruzione: a e b per le binarie, a per copy/branch/ret, args per i phi.
+int ir_operand_count(IrInsn* insn) {
+    if (insn->op == IR_PHI) return insn->nargs;
+    if (ir_is_binary(insn->op)) return 2;
+    switch (insn->op) {
+        case IR_COPY:
+        case IR_BRANCH:
+        case IR_RET:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Puntatore all'operando index, così i passi possono sia leggerlo sia riscriverlo.
+int* ir_operand(IrInsn* insn, int index) {
+    if (insn->op == IR_PHI) return &insn->args[index];
+    return index == 0 ? &insn->a : &insn->b;
+}
+
+// Numero di usi di ogni registro virtuale (array di nvregs + 1 elementi, da liberare col free).
+int* ir_use_counts(IrFunction* fn) {
+    int* counts = (int*)calloc((size_t)fn->nvregs + 1, sizeof(int));
+    if (!counts) {
+        perror("Errore di allocazione dell'IR");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            int n = ir_operand_count(&block->insns[j]);
+            for (int k = 0; k < n; k++) {
+                counts[*ir_operand(&block->insns[j], k)]++;
+            }
+        }
+    }
+    return counts;
+}
+
+// Valuta un'operazione binaria su costanti con l'aritmetica a 32 bit del bersaglio (in complemento a due).
+// Restituisce 0 se il risultato non si può calcolare a tempo di compilazione: la divisione per zero
+// e INT_MIN / -1 devono restare a run time, dove sollevano l'eccezione come farebbe idivl.
+int ir_eval_binary(IrOp op, int a, int b, int* result) {
+    unsigned int ua = (unsigned int)a;
+    unsigned int ub = (unsigned int)b;
+    switch (op) {
+        case IR_ADD: *result = (int)(ua + ub); return 1;
+        case IR_SUB: *result = (int)(ua - ub); return 1;
+        case IR_MUL: *result = (int)(ua * ub); return 1;
+        case IR_DIV:
+            if (b == 0 || (a == (int)0x80000000u && b == -1)) return 0;
+            *result = a / b;
+            return 1;
+        case IR_EQ: *result = a == b; return 1;
+        case IR_NE: *result = a != b; return 1;
+        case IR_LT: *result = a < b; return 1;
+        case IR_GT: *result = a > b; return 1;
+        default: return 0;
+    }
+}
+
+// Sposta l'istruzione index (un ex phi appena trasformato) subito dopo i phi del blocco,
+// che devono restare tutti in testa.
+void ir_move_after_phis(IrBlock* block, int index) {
+    IrInsn moved = block->insns[index];
+    while (index + 1 < block->ninsns && block->insns[index + 1].op == IR_PHI) {
+        block->insns[index] = block->insns[index + 1];
+        index++;
+    }
+    block->insns[index] = moved;
+}
+
+const char* ir_op_name(IrOp op) {
+    switch (op) {
+        case IR_CONST: return "const";
+        case IR_COPY: return "copy";
+        case IR_ADD: return "add";
+        case IR_SUB: return "sub";
+        case IR_MUL: return "mul";
+        case IR_DIV: return "div";
+        case IR_EQ: return "eq";
+        case IR_NE: return "ne";
+        case IR_LT: return "lt";
+        case IR_GT: return "gt";
+        case IR_PHI: return "phi";
+        case IR_JUMP: return "jump";
+        case IR_BRANCH: return "branch";
+        case IR_RET: return "ret";
+    }
+    return "?";
+}
+
+static void print_insn(IrBlock* block, IrInsn* insn, FILE* out) {
+    fprintf(out, "  ");
+    if (insn->dst) {
+        fprintf(out, "v%d = ", insn->dst);
+    }
+    fprintf(out, "%s", ir_op_name(insn->op));
+
+    switch (insn->op) {
+        case IR_CONST:
+            fprintf(out, " %d", insn->imm);
+            break;
+        case IR_COPY:
+        case IR_RET:
+            fprintf(out, " v%d", insn->a);
+            break;
+        case IR_PHI:
+            for (int i = 0; i < insn->nargs; i++) {
+                fprintf(out, "%s [v%d, B%d]", i ? "," : "", insn->args[i],
+                        i < block->npreds ? block->preds[i]->id : -1);
+            }
+            break;
+        case IR_JUMP:
+            fprintf(out, " B%d", block->succ[0]->id);
+            break;
+        case IR_BRANCH:
+            fprintf(out, " v%d, B%d, B%d", insn->a, block->succ[0]->id, block->succ[1]->id);
+            break;
+        default:
+            fprintf(out, " v%d, v%d", insn->a, insn->b);
+            break;
+    }
+    fprintf(out, "\n");
+}
+
+void ir_print_function(IrFunction* fn, FILE* out) {
+    fprintf(out, "function %s (registri virtuali %d)\n", fn->name, fn->nvregs);
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        fprintf(out, "B%d:", block->id);
+        if (block->npreds > 0) {
+            fprintf(out, "  ; pred");
+            for (int p = 0; p < block->npreds; p++) {
+                fprintf(out, " B%d", block->preds[p]->id);
+            }
+        }
+        if (block->idom) {
+            fprintf(out, "  ; idom B%d", block->idom->id);
+        }
+        if (block->loop) {
+            fprintf(out, "  ; ciclo B%d, profondità %d", block->loop->header->id, block->loop_depth);
+        }
+        fprintf(out, "\n");
+        for (int j = 0; j < block->ninsns; j++) {
+            print_insn(block, &block->insns[j], out);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+void ir_free_function(IrFunction* fn) {
+    if (!fn) return;
+    cfg_free(fn);
+    for (int i = 0; i < fn->nblocks; i++) {
+        for (int j = 0; j < fn->blocks[i]->ninsns; j++) {
+            free(fn->blocks[i]->insns[j].args);
+        }
+        free(fn->blocks[i]->insns);
+        free(fn->blocks[i]->preds);
+        free(fn->blocks[i]);
+    }
+    free(fn->blocks);
+    free(fn->name);
+    free(fn);
+}
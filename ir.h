@@ -0,0 +1,131 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+
+// Rappresentazione intermedia lineare a tre indirizzi.
+// Ogni funzione è una lista di blocchi base; ogni blocco è una sequenza di istruzioni che termina
+// con un salto esplicito (IR_JUMP, IR_BRANCH) o con IR_RET. I valori vivono in registri virtuali
+// numerati da 1 (0 significa "nessun registro").
+// lower.c produce l'IR già in forma SSA (ssa.c): le variabili locali diventano registri virtuali
+// definiti una sola volta, con dei phi in testa ai blocchi di confluenza. Prima del backend
+// ssa_destruct sostituisce i phi con delle copie.
+
+typedef enum {
+    IR_CONST,   // dst = imm
+    IR_COPY,    // dst = a
+    IR_ADD,     // dst = a + b
+    IR_SUB,     // dst = a - b
+    IR_MUL,     // dst = a * b
+    IR_DIV,     // dst = a / b
+    IR_EQ,      // dst = (a == b)
+    IR_NE,      // dst = (a != b)
+    IR_LT,      // dst = (a < b)
+    IR_GT,      // dst = (a > b)
+    IR_PHI,     // dst = args[i] se si arriva dal predecessore preds[i]; solo in testa al blocco
+    IR_JUMP,    // salta a succ[0]
+    IR_BRANCH,  // se a != 0 salta a succ[0], altrimenti a succ[1]
+    IR_RET      // restituisce a
+} IrOp;
+
+typedef struct IrInsn {
+    IrOp op;
+    int dst;    // registro virtuale definito, 0 se l'istruzione non produce un valore
+    int a;      // primo operando
+    int b;      // secondo operando
+    int imm;    // costante per IR_CONST
+    int* args;  // argomenti di IR_PHI, uno per predecessore nello stesso ordine di preds
+    int nargs;
+} IrInsn;
+
+typedef struct IrBlock IrBlock;
+typedef struct IrLoop IrLoop;
+
+struct IrBlock {
+    int id;
+    IrInsn* insns;
+    int ninsns;
+    int insn_cap;
+    IrBlock* succ[2];   // successori, nell'ordine definito dal terminatore
+    int nsucc;
+    IrBlock** preds;    // predecessori, nell'ordine in cui sono stati collegati
+    int npreds;
+    int pred_cap;
+
+    // Analisi del grafo di flusso, calcolate da cfg_build (cfg.c)
+    int rpo_index;          // posizione in ordine postordine inverso, -1 se irraggiungibile
+    IrBlock* idom;          // dominatore immediato, NULL per l'ingresso e i blocchi irraggiungibili
+    IrBlock** dom_children; // figli nell'albero dei dominatori
+    int ndom_children;
+    int dom_pre;            // numerazione dell'albero dei dominatori per cfg_dominates in O(1)
+    int dom_post;
+    IrLoop* loop;           // ciclo più interno che contiene il blocco, NULL se fuori da ogni ciclo
+    int loop_depth;         // 0 fuori dai cicli, 1 nel ciclo più esterno, ...
+};
+
+// Ciclo naturale: l'header domina tutti i blocchi del corpo, i latch chiudono gli archi all'indietro.
+struct IrLoop {
+    IrBlock* header;
+    IrBlock** blocks;   // header compreso
+    int nblocks;
+    IrBlock** latches;
+    int nlatches;
+    IrLoop* parent;     // ciclo che lo contiene direttamente, NULL se esterno
+    int depth;          // 1 per i cicli esterni
+    int nchildren;      // 0 per i cicli più interni
+};
+
+typedef struct IrFunction {
+    char* name;
+    IrBlock** blocks;   // blocchi nell'ordine di emissione; blocks[0] è l'ingresso
+    int nblocks;
+    int block_cap;
+    int next_block_id;
+    int nvregs;         // registri virtuali usati: 1..nvregs
+
+    // Analisi del grafo di flusso, calcolate da cfg_build (cfg.c)
+    IrBlock** rpo;      // blocchi raggiungibili in ordine postordine inverso
+    int nrpo;
+    IrLoop** loops;     // cicli naturali in ordine RPO degli header: ogni ciclo segue quello che lo contiene
+    int nloops;
+} IrFunction;
+
+// Costruzione
+IrFunction* ir_new_function(const char* name);
+IrBlock* ir_new_block(IrFunction* fn);
+void ir_place_block(IrFunction* fn, IrBlock* block);
+void ir_place_block_after(IrFunction* fn, IrBlock* block, IrBlock* after);
+int ir_new_vreg(IrFunction* fn);
+IrInsn* ir_append(IrBlock* block, IrOp op, int dst, int a, int b, int imm);
+IrInsn* ir_insert(IrBlock* block, int index, IrOp op, int dst, int a, int b, int imm);
+void ir_remove(IrBlock* block, int index);
+int ir_emit(IrFunction* fn, IrBlock* block, IrOp op, int a, int b, int imm);
+
+// Terminatori: aggiornano anche successori e predecessori
+void ir_jump(IrBlock* block, IrBlock* target);
+void ir_branch(IrBlock* block, int cond, IrBlock* if_true, IrBlock* if_false);
+void ir_ret(IrBlock* block, int value);
+int ir_is_terminated(IrBlock* block);
+IrInsn* ir_terminator(IrBlock* block);
+IrBlock* ir_split_edge(IrFunction* fn, IrBlock* from, int succ_index);
+void ir_remove_pred(IrBlock* block, int index);
+void ir_branch_to_jump(IrBlock* block, int keep);
+void ir_jump_replacing(IrBlock* block, IrBlock* target, IrBlock* old_pred);
+void ir_branch_replacing(IrBlock* block, int cond, IrBlock* if_true, IrBlock* if_false, IrBlock* old_pred);
+void ir_remove_terminator(IrBlock* block);
+void ir_remove_unreachable_blocks(IrFunction* fn);
+
+// Proprietà delle istruzioni
+int ir_is_binary(IrOp op);
+const char* ir_op_name(IrOp op);
+int ir_operand_count(IrInsn* insn);
+int* ir_operand(IrInsn* insn, int index);
+int* ir_use_counts(IrFunction* fn);
+int ir_eval_binary(IrOp op, int a, int b, int* result);
+void ir_move_after_phis(IrBlock* block, int index);
+
+// Stampa e pulizia
+void ir_print_function(IrFunction* fn, FILE* out);
+void ir_free_function(IrFunction* fn);
+
+#endif // IR_H
@@ -0,0 +1,297 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "ir.h"
+#include "cfg.h"
+#include "opt.h"
+
+// Variabili di induzione e riduzione della forza.
+// Una variabile di induzione di base è un phi dell'header "i = phi [init, i + step]" con step
+// invariante nel ciclo. Un'espressione derivata x = i, i + c oppure i - c (c invariante) moltiplicata
+// per un invariante k cresce di step * k a ogni iterazione: al posto della moltiplicazione si crea
+// una nuova variabile di induzione t = phi [x0 * k, t + step * k], con x0 * k e step * k calcolati
+// una volta nel preheader. L'aritmetica è modulo 2^32, quindi l'uguaglianza t == x * k vale sempre.
+//
+// Se dopo la riduzione la variabile di base serve solo al proprio aggiornamento e al test di uscita
+// "i < n", il test viene riscritto su t ("t < n * k") e i diventa codice morto, tolto da opt_dead_code.
+// La sostituzione del test è valida solo se né i né t possono traboccare: si applica quando init,
+// step, n e k sono costanti (step e k positivi) e tutti i valori assunti stanno in un int.
+
+typedef struct {
+    int phi;    // registro della variabile nell'header
+    int init;   // valore all'ingresso, dal preheader
+    int next;   // valore all'iterazione successiva, dal latch
+    int step;   // incremento invariante
+    int negative; // next = phi - step
+} InductionVar;
+
+// Variabile t = i * k creata dalla riduzione, candidata a sostituire i nel test di uscita.
+typedef struct {
+    int t;
+    int phi;
+    int k;
+} ReducedVar;
+
+typedef struct {
+    IrFunction* fn;
+    IrBlock** def_block;    // blocco che definisce ogni registro
+    IrLoop* loop;
+    IrBlock* preheader;
+    IrBlock* latch;
+    int pre_index;          // posizione del preheader tra i predecessori dell'header
+    InductionVar* ivs;
+    int nivs;
+    ReducedVar* reduced;
+    int nreduced;
+    int reduced_cap;
+} IvState;
+
+static void* iv_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione della riduzione della forza");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// L'istruzione che definisce il registro (il puntatore vale fino alla prossima modifica del blocco).
+static IrInsn* find_def(IvState* state, int vreg) {
+    IrBlock* block = state->def_block[vreg];
+    if (!block) return NULL;
+    for (int j = 0; j < block->ninsns; j++) {
+        if (block->insns[j].dst == vreg) return &block->insns[j];
+    }
+    return NULL;
+}
+
+static int is_invariant(IvState* state, int vreg) {
+    IrBlock* block = state->def_block[vreg];
+    return block && !cfg_loop_contains(state->loop, block);
+}
+
+static int constant_value(IvState* state, int vreg, int* value) {
+    IrInsn* def = find_def(state, vreg);
+    if (!def || def->op != IR_CONST) return 0;
+    *value = def->imm;
+    return 1;
+}
+
+static InductionVar* find_iv(IvState* state, int vreg) {
+    for (int i = 0; i < state->nivs; i++) {
+        if (state->ivs[i].phi == vreg) return &state->ivs[i];
+    }
+    return NULL;
+}
+
+static void find_basic_ivs(IvState* state) {
+    IrBlock* header = state->loop->header;
+    int latch_index = 1 - state->pre_index;
+    state->ivs = (InductionVar*)iv_alloc((size_t)header->ninsns, sizeof(InductionVar));
+    state->nivs = 0;
+    for (int j = 0; j < header->ninsns && header->insns[j].op == IR_PHI; j++) {
+        IrInsn* phi = &header->insns[j];
+        InductionVar iv = { phi->dst, phi->args[state->pre_index], phi->args[latch_index], 0, 0 };
+        IrInsn* update = find_def(state, iv.next);
+        if (!update) continue;
+        if (update->op == IR_ADD && update->a == iv.phi && is_invariant(state, update->b)) {
+            iv.step = update->b;
+        } else if (update->op == IR_ADD && update->b == iv.phi && is_invariant(state, update->a)) {
+            iv.step = update->a;
+        } else if (update->op == IR_SUB && update->a == iv.phi && is_invariant(state, update->b)) {
+            iv.step = update->b;
+            iv.negative = 1;
+        } else {
+            continue;
+        }
+        state->ivs[state->nivs++] = iv;
+    }
+}
+
+// Riconosce x = i, i + c, c + i, i - c; restituisce la variabile di base e lo scostamento (0 se assente).
+static InductionVar* match_derived(IvState* state, int x, int* offset, IrOp* offset_op) {
+    *offset = 0;
+    *offset_op = IR_ADD;
+    InductionVar* iv = find_iv(state, x);
+    if (iv) return iv;
+    IrInsn* def = find_def(state, x);
+    if (!def || (def->op != IR_ADD && def->op != IR_SUB)) return NULL;
+    if ((iv = find_iv(state, def->a)) && is_invariant(state, def->b)) {
+        *offset = def->b;
+        *offset_op = def->op;
+        return iv;
+    }
+    if (def->op == IR_ADD && (iv = find_iv(state, def->b)) && is_invariant(state, def->a)) {
+        *offset = def->a;
+        return iv;
+    }
+    return NULL;
+}
+
+// Registra il blocco di un registro appena creato, allargando def_block.
+static void note_def(IvState* state, int vreg, IrBlock* block) {
+    state->def_block = (IrBlock**)realloc(state->def_block, ((size_t)state->fn->nvregs + 1) * sizeof(IrBlock*));
+    if (!state->def_block) {
+        perror("Errore di allocazione della riduzione della forza");
+        exit(EXIT_FAILURE);
+    }
+    state->def_block[vreg] = block;
+}
+
+// Aggiunge un'istruzione in fondo al blocco, prima del terminatore.
+static int emit_in(IvState* state, IrBlock* block, IrOp op, int a, int b, int imm) {
+    int dst = ir_new_vreg(state->fn);
+    ir_insert(block, block->ninsns - 1, op, dst, a, b, imm);
+    note_def(state, dst, block);
+    return dst;
+}
+
+// Crea la variabile t = (x0 * k) che avanza di step * k insieme a iv, e la restituisce.
+static int create_reduced_iv(IvState* state, InductionVar* iv, int offset, IrOp offset_op, int k) {
+    IrBlock* header = state->loop->header;
+    int x0 = iv->init;
+    if (offset) {
+        x0 = emit_in(state, state->preheader, offset_op, iv->init, offset, 0);
+    }
+    int start = emit_in(state, state->preheader, IR_MUL, x0, k, 0);
+    int stride = emit_in(state, state->preheader, IR_MUL, iv->step, k, 0);
+
+    int phi = ir_new_vreg(state->fn);
+    IrInsn* insn = ir_insert(header, 0, IR_PHI, phi, 0, 0, 0);
+    insn->args = (int*)iv_alloc(2, sizeof(int));
+    insn->nargs = 2;
+    insn->args[state->pre_index] = start;
+    note_def(state, phi, header);
+
+    int next = emit_in(state, state->latch, iv->negative ? IR_SUB : IR_ADD, phi, stride, 0);
+    header->insns[0].args[1 - state->pre_index] = next;
+    return phi;
+}
+
+// Moltiplicazioni dentro il ciclo per una variabile di induzione (anche derivata) e un invariante.
+static void reduce_multiplications(IvState* state) {
+    for (int i = 0; i < state->loop->nblocks; i++) {
+        IrBlock* block = state->loop->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            if (insn->op != IR_MUL) continue;
+            int dst = insn->dst;
+            int operands[2] = { insn->a, insn->b };
+            for (int side = 0; side < 2; side++) {
+                int x = operands[side];
+                int k = operands[1 - side];
+                int offset;
+                IrOp offset_op;
+                InductionVar* iv = is_invariant(state, k) ? match_derived(state, x, &offset, &offset_op) : NULL;
+                if (!iv) continue;
+
+                int t = create_reduced_iv(state, iv, offset, offset_op, k);
+                if (!offset) {
+                    if (state->nreduced == state->reduced_cap) {
+                        state->reduced_cap = state->reduced_cap ? state->reduced_cap * 2 : 8;
+                        state->reduced = (ReducedVar*)realloc(state->reduced, (size_t)state->reduced_cap * sizeof(ReducedVar));
+                        if (!state->reduced) {
+                            perror("Errore di allocazione della riduzione della forza");
+                            exit(EXIT_FAILURE);
+                        }
+                    }
+                    ReducedVar reduced = { t, iv->phi, k };
+                    state->reduced[state->nreduced++] = reduced;
+                }
+                // create_reduced_iv ha inserito un phi in testa all'header: la posizione può essere cambiata
+                for (int p = 0; p < block->ninsns; p++) {
+                    if (block->insns[p].dst == dst) {
+                        block->insns[p].op = IR_COPY;
+                        block->insns[p].a = t;
+                        block->insns[p].b = 0;
+                        break;
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Riscrive il test "i < n" dell'header come "t < n * k" con t = i * k, se non c'è trabocco.
+static void replace_exit_test(IvState* state, int* uses) {
+    IrBlock* header = state->loop->header;
+    IrInsn* branch = ir_terminator(header);
+    if (!branch || branch->op != IR_BRANCH) return;
+    IrInsn* test = find_def(state, branch->a);
+    if (!test || state->def_block[branch->a] != header) return;
+
+    int iv_vreg, bound;
+    if (test->op == IR_LT) {
+        iv_vreg = test->a;
+        bound = test->b;
+    } else if (test->op == IR_GT) {
+        iv_vreg = test->b;
+        bound = test->a;
+    } else {
+        return;
+    }
+    InductionVar* iv = find_iv(state, iv_vreg);
+    int init, step, n;
+    if (!iv || iv->negative || uses[iv->phi] != 2 || uses[branch->a] != 1) return;
+    if (!constant_value(state, iv->init, &init) || !constant_value(state, iv->step, &step) ||
+        !constant_value(state, bound, &n) || step <= 0 || !is_invariant(state, bound)) return;
+
+    for (int r = 0; r < state->nreduced; r++) {
+        int k;
+        if (state->reduced[r].phi != iv->phi) continue;
+        if (!constant_value(state, state->reduced[r].k, &k) || k <= 0) continue;
+
+        // i va da init a max(init, n + step - 1), crescendo: basta controllare gli estremi
+        long long high = (long long)n + step - 1;
+        if (high < init) high = init;
+        if (high > INT_MAX || high * k > INT_MAX || (long long)init * k < INT_MIN ||
+            (long long)n * k > INT_MAX || (long long)n * k < INT_MIN) continue;
+
+        int scaled = emit_in(state, state->preheader, IR_CONST, 0, 0, n * k);
+        test = find_def(state, branch->a);
+        test->op = IR_LT;
+        test->a = state->reduced[r].t;
+        test->b = scaled;
+        return;
+    }
+}
+
+void opt_reduce_strength(IrFunction* fn) {
+    if (fn->nloops == 0) return;
+
+    IvState state;
+    state.fn = fn;
+    state.def_block = (IrBlock**)iv_alloc((size_t)fn->nvregs + 1, sizeof(IrBlock*));
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            if (block->insns[j].dst) state.def_block[block->insns[j].dst] = block;
+        }
+    }
+
+    state.reduced = NULL;
+    state.reduced_cap = 0;
+    // Dal ciclo più interno, come in licm.c
+    for (int l = fn->nloops - 1; l >= 0; l--) {
+        IrLoop* loop = fn->loops[l];
+        state.loop = loop;
+        state.preheader = cfg_loop_preheader(loop);
+        if (!state.preheader || loop->nlatches != 1 || loop->header->npreds != 2) continue;
+        state.latch = loop->latches[0];
+        state.pre_index = loop->header->preds[0] == state.preheader ? 0 : 1;
+
+        find_basic_ivs(&state);
+        state.nreduced = 0;
+        reduce_multiplications(&state);
+        if (state.nreduced > 0) {
+            int* uses = ir_use_counts(fn);
+            replace_exit_test(&state, uses);
+            free(uses);
+        }
+        free(state.ivs);
+    }
+    free(state.def_block);
+    free(state.reduced);
+    opt_propagate_copies(fn);
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "cfg.h"
+#include "opt.h"
+
+// Spostamento del codice invariante fuori dai cicli.
+// Un'istruzione del ciclo i cui operandi sono tutti definiti fuori dal ciclo (o da istruzioni già
+// spostate) calcola lo stesso valore a ogni iterazione: la si sposta nel preheader, il blocco che
+// precede l'header ed eseguito una volta sola prima di entrare nel ciclo. In forma SSA basta
+// spostarla: il registro definito resta lo stesso e domina ancora tutti i suoi usi.
+//
+// Il preheader viene eseguito anche quando il corpo del while non lo è mai. Le operazioni
+// aritmetiche si possono calcolare in più senza conseguenze, la divisione no: si sposta solo se
+// sta nell'header (eseguito almeno una volta a ogni ingresso nel ciclo) o se il divisore è una
+// costante che non può fermare il programma.
+// I cicli si visitano dal più interno: ciò che esce da un ciclo interno può poi uscire anche da
+// quello che lo contiene.
+
+static void* licm_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione dello spostamento del codice invariante");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Garantisce un preheader a ogni ciclo con un solo arco entrante, spezzando l'arco se il
+// predecessore si dirama. Restituisce 1 se ha aggiunto blocchi (va rifatto cfg_build).
+static int insert_preheaders(IrFunction* fn) {
+    int added = 0;
+    for (int l = 0; l < fn->nloops; l++) {
+        IrLoop* loop = fn->loops[l];
+        if (cfg_loop_preheader(loop)) continue;
+        IrBlock* outside = NULL;
+        int entries = 0;
+        for (int p = 0; p < loop->header->npreds; p++) {
+            if (!cfg_loop_contains(loop, loop->header->preds[p])) {
+                outside = loop->header->preds[p];
+                entries++;
+            }
+        }
+        if (entries != 1) continue;
+        for (int s = 0; s < outside->nsucc; s++) {
+            if (outside->succ[s] == loop->header) {
+                ir_split_edge(fn, outside, s);
+                added = 1;
+                break;
+            }
+        }
+    }
+    return added;
+}
+
+static int is_hoistable(IrBlock** def_block, IrLoop* loop, IrBlock* block, IrInsn* insn) {
+    if (insn->op == IR_DIV && block != loop->header) {
+        IrBlock* divisor_block = def_block[insn->b];
+        if (!divisor_block) return 0;
+        for (int j = 0; j < divisor_block->ninsns; j++) {
+            IrInsn* def = &divisor_block->insns[j];
+            if (def->dst == insn->b) {
+                if (def->op != IR_CONST || def->imm == 0 || def->imm == -1) return 0;
+                break;
+            }
+        }
+    } else if (insn->op != IR_CONST && !ir_is_binary(insn->op)) {
+        return 0;
+    }
+    int n = ir_operand_count(insn);
+    for (int k = 0; k < n; k++) {
+        IrBlock* def = def_block[*ir_operand(insn, k)];
+        if (!def || cfg_loop_contains(loop, def)) return 0;
+    }
+    return 1;
+}
+
+static void hoist_loop(IrBlock** def_block, IrLoop* loop, IrBlock* preheader) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < loop->nblocks; i++) {
+            IrBlock* block = loop->blocks[i];
+            for (int j = 0; j < block->ninsns; ) {
+                IrInsn* insn = &block->insns[j];
+                if (!is_hoistable(def_block, loop, block, insn)) {
+                    j++;
+                    continue;
+                }
+                IrInsn moved = *insn;
+                ir_insert(preheader, preheader->ninsns - 1, moved.op, moved.dst, moved.a, moved.b, moved.imm);
+                def_block[moved.dst] = preheader;
+                // L'istruzione non ha argomenti di phi: basta toglierla dal blocco
+                ir_remove(block, j);
+                changed = 1;
+            }
+        }
+    }
+}
+
+void opt_hoist_invariants(IrFunction* fn) {
+    if (fn->nloops == 0) return;
+    if (insert_preheaders(fn)) {
+        cfg_build(fn);
+    }
+
+    IrBlock** def_block = (IrBlock**)licm_alloc((size_t)fn->nvregs + 1, sizeof(IrBlock*));
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            if (block->insns[j].dst) def_block[block->insns[j].dst] = block;
+        }
+    }
+
+    // fn->loops ha ogni ciclo dopo quello che lo contiene: all'indietro si parte dai più interni
+    for (int l = fn->nloops - 1; l >= 0; l--) {
+        IrLoop* loop = fn->loops[l];
+        IrBlock* preheader = cfg_loop_preheader(loop);
+        if (preheader) {
+            hoist_loop(def_block, loop, preheader);
+        }
+    }
+    free(def_block);
+}
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ast.h"
+#include "ir.h"
+#include "lower.h"
+#include "ssa.h"
+
+// Stato dell'abbassamento della funzione corrente: la funzione IR e il blocco in cui si sta scrivendo.
+// Le variabili locali non passano dalla memoria: ogni lettura e scrittura diventa un valore SSA (ssa.c).
+static IrFunction* fn = NULL;
+static IrBlock* current = NULL;
+
+static void lower_statements(List* list);
+
+// Da qui in poi le istruzioni finiscono nel blocco indicato, che entra nell'ordine di emissione.
+static void start_block(IrBlock* block) {
+    ir_place_block(fn, block);
+    current = block;
+}
+
+// Crea un blocco i cui predecessori sono tutti già noti (o che non ne avrà) e ci si posiziona.
+static void start_sealed_block(IrBlock* block) {
+    start_block(block);
+    ssa_seal_block(block);
+}
+
+static IrOp binary_ir_op(NodeType type) {
+    switch (type) {
+        case NODE_PLUS: return IR_ADD;
+        case NODE_MINUS: return IR_SUB;
+        case NODE_MULT: return IR_MUL;
+        case NODE_DIVIDE: return IR_DIV;
+        case NODE_EQUAL_OP: return IR_EQ;
+        case NODE_NOT_EQUAL_OP: return IR_NE;
+        case NODE_LESS_THAN_OP: return IR_LT;
+        default: return IR_GT;
+    }
+}
+
+// Numero di Sethi e Ullman: quanti valori intermedi restano vivi insieme valutando l'espressione.
+// Costanti e variabili non ne richiedono (le costanti diventano immediati, le variabili sono già
+// registri virtuali); un nodo binario ne richiede uno in più solo se i due figli ne richiedono
+// lo stesso numero. *has_assignment segnala le assegnazioni, che fissano l'ordine di valutazione.
+static int register_need(Node* node, int* has_assignment) {
+    switch (node->type) {
+        case NODE_ASSIGN_OP:
+            *has_assignment = 1;
+            return register_need(node->assign_op.expression, has_assignment);
+        case NODE_PLUS:
+        case NODE_MINUS:
+        case NODE_MULT:
+        case NODE_DIVIDE:
+        case NODE_EQUAL_OP:
+        case NODE_NOT_EQUAL_OP:
+        case NODE_LESS_THAN_OP:
+        case NODE_GREATER_THAN_OP: {
+            int left = register_need(node->binary_op.left, has_assignment);
+            int right = register_need(node->binary_op.right, has_assignment);
+            if (left == right) return left + 1;
+            return left > right ? left : right;
+        }
+        default:
+            return 0;
+    }
+}
+
+// Abbassa un'espressione e restituisce il registro virtuale che ne contiene il valore.
+static int lower_expression(Node* node) {
+    switch (node->type) {
+        case NODE_NUMBER:
+            return ir_emit(fn, current, IR_CONST, 0, 0, node->number_val);
+        case NODE_IDENTIFIER:
+            return ssa_read_variable(node->slot, current);
+        case NODE_ASSIGN_OP: {
+            // L'assegnazione è un'espressione: il suo valore è quello assegnato.
+            int value = lower_expression(node->assign_op.expression);
+            ssa_write_variable(node->slot, current, value);
+            return value;
+        }
+        case NODE_PLUS:
+        case NODE_MINUS:
+        case NODE_MULT:
+        case NODE_DIVIDE:
+        case NODE_EQUAL_OP:
+        case NODE_NOT_EQUAL_OP:
+        case NODE_LESS_THAN_OP:
+        case NODE_GREATER_THAN_OP: {
+            // Si valuta prima il figlio più impegnativo: il risultato dell'altro resta vivo per meno
+            // istruzioni. Con un'assegnazione in uno dei due figli si resta da sinistra a destra.
+            int has_assignment = 0;
+            int left_need = register_need(node->binary_op.left, &has_assignment);
+            int right_need = register_need(node->binary_op.right, &has_assignment);
+            int left;
+            int right;
+            if (right_need > left_need && !has_assignment) {
+                right = lower_expression(node->binary_op.right);
+                left = lower_expression(node->binary_op.left);
+            } else {
+                left = lower_expression(node->binary_op.left);
+                right = lower_expression(node->binary_op.right);
+            }
+            return ir_emit(fn, current, binary_ir_op(node->type), left, right, 0);
+        }
+        default:
+            fprintf(stderr, "Errore interno: nodo %d non è un'espressione.\n", node->type);
+            exit(EXIT_FAILURE);
+    }
+}
+
+static void lower_statement(Node* node) {
+    switch (node->type) {
+        case NODE_DECLARATION:
+            // Lo slot è già stato assegnato dall'analisi semantica: nessun codice.
+            break;
+        case NODE_EXPR_STMT:
+            lower_expression(node->expr_stmt.expression);
+            break;
+        case NODE_RETURN_STMT: {
+            int value = lower_expression(node->return_stmt.expression);
+            ir_ret(current, value);
+            // Le istruzioni dopo un return finiscono in un blocco senza predecessori.
+            start_sealed_block(ir_new_block(fn));
+            break;
+        }
+        case NODE_IF_STMT: {
+            IrBlock* then_block = ir_new_block(fn);
+            IrBlock* end_block = ir_new_block(fn);
+            int cond = lower_expression(node->if_stmt.condition);
+            ir_branch(current, cond, then_block, end_block);
+            start_sealed_block(then_block);
+            lower_statements(node->if_stmt.if_body);
+            ir_jump(current, end_block);
+            start_sealed_block(end_block);
+            break;
+        }
+        case NODE_IF_ELSE_STMT: {
+            IrBlock* then_block = ir_new_block(fn);
+            IrBlock* else_block = ir_new_block(fn);
+            IrBlock* end_block = ir_new_block(fn);
+            int cond = lower_expression(node->if_stmt.condition);
+            ir_branch(current, cond, then_block, else_block);
+            start_sealed_block(then_block);
+            lower_statements(node->if_stmt.if_body);
+            ir_jump(current, end_block);
+            start_sealed_block(else_block);
+            lower_statements(node->if_stmt.else_body);
+            ir_jump(current, end_block);
+            start_sealed_block(end_block);
+            break;
+        }
+        case NODE_WHILE_STMT: {
+            IrBlock* header = ir_new_block(fn);
+            IrBlock* body = ir_new_block(fn);
+            IrBlock* exit_block = ir_new_block(fn);
+            ir_jump(current, header);
+            // L'header resta aperto finché non si conosce l'arco all'indietro dal corpo.
+            start_block(header);
+            int cond = lower_expression(node->while_stmt.condition);
+            ir_branch(current, cond, body, exit_block);
+            start_sealed_block(body);
+            lower_statements(node->while_stmt.while_body);
+            ir_jump(current, header);
+            ssa_seal_block(header);
+            start_sealed_block(exit_block);
+            break;
+        }
+        default:
+            fprintf(stderr, "Errore interno: nodo %d non è un'istruzione.\n", node->type);
+            exit(EXIT_FAILURE);
+    }
+}
+
+static void lower_statements(List* list) {
+    for (List* item = list; item != NULL; item = item->next) {
+        lower_statement(item->node);
+    }
+}
+
+IrFunction* lower_function(Node* function) {
+    // Gli slot di sema.c servono solo a numerare le variabili per la forma SSA.
+    fn = ir_new_function(function->function_def.name);
+    ssa_begin(fn, function->function_def.frame_slots);
+    start_sealed_block(ir_new_block(fn));
+
+    lower_statements(function->function_def.statements);
+
+    // Una funzione che arriva in fondo senza return restituisce 0.
+    if (!ir_is_terminated(current)) {
+        ir_ret(current, ir_emit(fn, current, IR_CONST, 0, 0, 0));
+    }
+    ssa_finish();
+
+    IrFunction* result = fn;
+    fn = NULL;
+    current = NULL;
+    return result;
+}
@@ -0,0 +1,10 @@
+#ifndef LOWER_H
+#define LOWER_H
+
+#include "ast.h"
+#include "ir.h"
+
+// Traduce un NODE_FUNCTION (con i nomi già risolti da sema.c) nella rappresentazione intermedia.
+IrFunction* lower_function(Node* function);
+
+#endif // LOWER_H
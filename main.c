@@ -1,7 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "ast.h"
 #include "codegen.h"
+#include "sema.h"
 
 // Dichiarazione delle funzioni esterne del parser
 extern int yyparse();
@@ -11,21 +13,70 @@ extern Node* ast; // Questa è la variabile definita nel parser
 // Definizione della variabile globale per la radice dell'AST
 Node* ast_root = NULL;
 
+static void print_usage(const char* program) {
+    fprintf(stderr, "Uso: %s [-O0|-O1|-O2] [--unroll=N] [--dump-ast[=text|json|dot]] [--dump-ir] <file_di_input.mc>\n", program);
+}
+
 int main(int argc, char **argv) {
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <file_di_input.mc>\n", argv[0]);
+    const char* input_path = NULL;
+    int dump_ast_enabled = 0;
+    AstDumpFormat dump_format = AST_DUMP_TEXT;
+
+    // Lettura delle opzioni: la stampa dell'AST è disattivata di default
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dump-ast") == 0 || strcmp(argv[i], "--dump-ast=text") == 0) {
+            dump_ast_enabled = 1;
+            dump_format = AST_DUMP_TEXT;
+        } else if (strcmp(argv[i], "--dump-ast=json") == 0) {
+            dump_ast_enabled = 1;
+            dump_format = AST_DUMP_JSON;
+        } else if (strcmp(argv[i], "--dump-ast=dot") == 0) {
+            dump_ast_enabled = 1;
+            dump_format = AST_DUMP_DOT;
+        } else if (strcmp(argv[i], "--dump-ir") == 0) {
+            codegen_options.dump_ir = 1;
+        } else if (strcmp(argv[i], "-O0") == 0) {
+            codegen_options.opt_level = 0;
+        } else if (strcmp(argv[i], "-O1") == 0 || strcmp(argv[i], "-O") == 0) {
+            codegen_options.opt_level = 1;
+        } else if (strcmp(argv[i], "-O2") == 0) {
+            codegen_options.opt_level = 2;
+        } else if (strncmp(argv[i], "--unroll=", 9) == 0) {
+            char* end;
+            long factor = strtol(argv[i] + 9, &end, 10);
+            if (*end != '\0' || end == argv[i] + 9 || factor < 0 || factor > 64) {
+                fprintf(stderr, "Fattore di srotolamento non valido: %s\n", argv[i] + 9);
+                print_usage(argv[0]);
+                return 1;
+            }
+            codegen_options.unroll = (int)factor;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Opzione sconosciuta: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        } else if (!input_path) {
+            input_path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!input_path) {
+        print_usage(argv[0]);
         return 1;
     }
 
     // Apri il file di input
-    yyin = fopen(argv[1], "r");
+    yyin = fopen(input_path, "r");
     if (!yyin) {
         perror("Errore nell'apertura del file di input");
         return 1;
     }
 
     // Analisi sintattica e costruzione dell'AST
-    printf("Parsing in corso...\n");
+    // I messaggi di stato vanno su stderr, così stdout resta pulito per --dump-ast=json/dot
+    fprintf(stderr, "Parsing in corso...\n");
     int result = yyparse();
     
     // Chiudi il file di input
@@ -34,12 +85,21 @@ int main(int argc, char **argv) {
     // Se l'analisi sintattica ha avuto successo, genera l'output
     if (result == 0 && ast) {
         ast_root = ast; // Copia il riferimento
-        printf("AST generato con successo. Stampa dell'AST:\n");
-        print_ast(ast_root, 0);
+        if (dump_ast_enabled) {
+            dump_ast(ast_root, dump_format, stdout);
+        }
+
+        // Analisi semantica: gli errori (variabili non dichiarate o duplicate) sono bloccanti
+        int errors = resolve_names(ast_root);
+        if (errors > 0) {
+            fprintf(stderr, "%d errori semantici. Nessun codice generato.\n", errors);
+            free_ast(ast_root);
+            return 1;
+        }
         
-        printf("\nGenerazione del codice assembly...\n");
+        fprintf(stderr, "Generazione del codice assembly...\n");
         generate_assembly(ast_root, "output.s");
-        printf("Codice assembly salvato in 'output.s'.\n");
+        fprintf(stderr, "Codice assembly salvato in 'output.s'.\n");
         
         free_ast(ast_root);
     } else {
@@ -140,21 +140,23 @@ enum yysymbol_kind_t
   YYSYMBOL_IDENTIFIER = 31,                /* IDENTIFIER  */
   YYSYMBOL_YYACCEPT = 32,                  /* $accept  */
   YYSYMBOL_program = 33,                   /* program  */
-  YYSYMBOL_function_declaration = 34,      /* function_declaration  */
-  YYSYMBOL_declarations = 35,              /* declarations  */
-  YYSYMBOL_statements = 36,                /* statements  */
-  YYSYMBOL_statement = 37,                 /* statement  */
-  YYSYMBOL_declaration_statement = 38,     /* declaration_statement  */
-  YYSYMBOL_return_statement = 39,          /* return_statement  */
-  YYSYMBOL_expression_statement = 40,      /* expression_statement  */
-  YYSYMBOL_expression = 41,                /* expression  */
-  YYSYMBOL_assignment_expression = 42,     /* assignment_expression  */
-  YYSYMBOL_relational_expression = 43,     /* relational_expression  */
-  YYSYMBOL_additive_expression = 44,       /* additive_expression  */
-  YYSYMBOL_multiplicative_expression = 45, /* multiplicative_expression  */
-  YYSYMBOL_primary_expression = 46,        /* primary_expression  */
-  YYSYMBOL_if_statement = 47,              /* if_statement  */
-  YYSYMBOL_while_statement = 48            /* while_statement  */
+  YYSYMBOL_functions = 34,                 /* functions  */
+  YYSYMBOL_function_declaration = 35,      /* function_declaration  */
+  YYSYMBOL_declarations = 36,              /* declarations  */
+  YYSYMBOL_statements = 37,                /* statements  */
+  YYSYMBOL_statement = 38,                 /* statement  */
+  YYSYMBOL_declaration_statement = 39,     /* declaration_statement  */
+  YYSYMBOL_return_statement = 40,          /* return_statement  */
+  YYSYMBOL_expression_statement = 41,      /* expression_statement  */
+  YYSYMBOL_expression = 42,                /* expression  */
+  YYSYMBOL_assignment_expression = 43,     /* assignment_expression  */
+  YYSYMBOL_relational_expression = 44,     /* relational_expression  */
+  YYSYMBOL_additive_expression = 45,       /* additive_expression  */
+  YYSYMBOL_multiplicative_expression = 46, /* multiplicative_expression  */
+  YYSYMBOL_primary_expression = 47,        /* primary_expression  */
+  YYSYMBOL_block = 48,                     /* block  */
+  YYSYMBOL_if_statement = 49,              /* if_statement  */
+  YYSYMBOL_while_statement = 50            /* while_statement  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -480,16 +482,16 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  5
+#define YYFINAL  6
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   80
+#define YYLAST   66
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  32
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  17
+#define YYNNTS  19
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  34
+#define YYNRULES  37
 /* YYNSTATES -- Number of states.  */
 #define YYNSTATES  73
 
@@ -543,10 +545,10 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int8 yyrline[] =
 {
-       0,    69,    69,    71,    75,    76,    78,    79,    81,    82,
-      83,    84,    86,    88,    90,    92,    94,    95,    97,    98,
-      99,   100,   101,   103,   104,   105,   107,   108,   109,   111,
-     112,   113,   115,   116,   118
+       0,    71,    71,    73,    74,    76,    80,    81,    83,    84,
+      86,    87,    88,    89,    91,    93,    95,    97,    99,   100,
+     102,   103,   104,   105,   106,   108,   109,   110,   112,   113,
+     114,   116,   117,   118,   121,   123,   124,   126
 };
 #endif
 
@@ -567,12 +569,12 @@ static const char *const yytname[] =
   "LPAR", "RPAR", "COMMA", "ASG_OP", "PLUS", "MINUS", "MULT", "DIVIDE",
   "EQ_OP", "NOT_EQ_OP", "LESS_THAN_OP", "GREATER_THAN_OP", "LESS_EQ_OP",
   "GREATER_EQ_OP", "AND_OP", "OR_OP", "NOT_OP", "NUMBER", "IDENTIFIER",
-  "$accept", "program", "function_declaration", "declarations",
-  "statements", "statement", "declaration_statement", "return_statement",
-  "expression_statement", "expression", "assignment_expression",
-  "relational_expression", "additive_expression",
-  "multiplicative_expression", "primary_expression", "if_statement",
-  "while_statement", YY_NULLPTR
+  "$accept", "program", "functions", "function_declaration",
+  "declarations", "statements", "statement", "declaration_statement",
+  "return_statement", "expression_statement", "expression",
+  "assignment_expression", "relational_expression", "additive_expression",
+  "multiplicative_expression", "primary_expression", "block",
+  "if_statement", "while_statement", YY_NULLPTR
 };
 
 static const char *
@@ -582,7 +584,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-60)
+#define YYPACT_NINF (-38)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -596,14 +598,14 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-      -1,   -25,    22,   -60,     2,   -60,    19,    27,   -60,    37,
-      13,    -5,   -60,    48,    11,    34,    58,   -60,    11,   -60,
-      45,   -60,   -60,   -60,    62,   -60,   -60,    46,    -6,   -60,
-     -60,   -60,   -60,    63,    11,    11,    60,    11,   -60,    18,
-      18,    18,    18,    18,    18,    18,    18,   -60,    61,    64,
-     -60,   -60,   -60,    -6,    -6,     1,     1,     1,     1,   -60,
-     -60,    65,    66,   -60,   -60,     4,    15,    72,   -60,    69,
-     -60,    24,   -60
+       8,   -16,    21,     8,   -38,    20,   -38,   -38,    22,    26,
+     -38,    37,    19,    -5,   -38,    41,   -11,    42,    43,   -38,
+     -11,   -38,    38,   -38,   -38,   -38,    47,   -38,   -38,    25,
+      -6,   -38,   -38,   -38,   -38,    48,   -11,   -11,    45,   -11,
+     -38,    -7,    -7,    -7,    -7,    -7,    -7,    -7,    -7,   -38,
+      46,    49,   -38,   -38,   -38,    -6,    -6,   -13,   -13,   -13,
+     -13,   -38,   -38,    50,    50,   -38,    55,   -38,    37,    50,
+       4,   -38,   -38
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -611,28 +613,28 @@ static const yytype_int8 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       0,     0,     0,     2,     0,     1,     0,     0,     5,     7,
-       0,     0,     4,     0,     0,     0,     0,     3,     0,    29,
-      30,     6,    11,     8,     0,    15,    17,    22,    25,    28,
-       9,    10,    12,     0,     0,     0,     0,     0,    14,     0,
-       0,     0,     0,     0,     0,     0,     0,    13,     0,     0,
-      31,    16,    30,    23,    24,    18,    19,    20,    21,    26,
-      27,     0,     0,     7,     7,     0,     0,    32,    34,     0,
-       7,     0,    33
+       0,     0,     0,     2,     4,     0,     1,     3,     0,     0,
+       7,     9,     0,     0,     6,     0,     0,     0,     0,     5,
+       0,    31,    32,     8,    13,    10,     0,    17,    19,    24,
+      27,    30,    11,    12,    14,     0,     0,     0,     0,     0,
+      16,     0,     0,     0,     0,     0,     0,     0,     0,    15,
+       0,     0,    33,    18,    32,    25,    26,    20,    21,    22,
+      23,    28,    29,     0,     0,     7,    35,    37,     9,     0,
+       0,    36,    34
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -60,   -60,   -60,   -60,   -59,   -60,   -60,   -60,   -60,    25,
-     -60,   -60,     9,    17,    20,   -60,   -60
+     -38,   -38,   -38,    61,     0,    -2,   -38,   -38,   -38,   -38,
+       2,   -38,   -38,   -15,     3,     5,   -37,   -38,   -38
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-       0,     2,     3,     9,    11,    21,    12,    22,    23,    24,
-      25,    26,    27,    28,    29,    30,    31
+       0,     2,     3,     4,    11,    13,    23,    14,    24,    25,
+      26,    27,    28,    29,    30,    31,    66,    32,    33
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -640,60 +642,56 @@ static const yytype_int8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int8 yytable[] =
 {
-      14,    15,     1,    16,    65,    66,     4,    17,    18,    14,
-      15,    71,    16,    45,    46,     6,    67,    18,    39,    40,
-      14,    15,     5,    16,    18,    19,    20,    68,    18,    14,
-      15,    18,    16,     7,    19,    20,    72,    18,     8,    33,
-      10,    19,    20,    36,    13,    19,    20,    34,    19,    52,
-      55,    56,    57,    58,    19,    20,    53,    54,    32,    48,
-      49,    37,    51,    39,    40,    59,    60,    41,    42,    43,
-      44,    35,    38,    47,    50,    61,    63,    64,    62,    69,
-      70
+      16,    17,    20,    18,    41,    42,    20,    19,    20,    16,
+      17,     1,    18,    47,    48,     5,    72,    20,    35,    21,
+      22,     6,    38,    21,    54,    21,    22,    67,    57,    58,
+      59,    60,    71,     8,    21,    22,     9,    10,    50,    51,
+      12,    53,    41,    42,    55,    56,    43,    44,    45,    46,
+      15,    34,    61,    62,    39,    36,    37,    40,    49,    52,
+      63,    65,    69,    64,     7,    68,    70
 };
 
 static const yytype_int8 yycheck[] =
 {
-       5,     6,     3,     8,    63,    64,    31,    12,    13,     5,
-       6,    70,     8,    19,    20,    13,    12,    13,    17,    18,
-       5,     6,     0,     8,    13,    30,    31,    12,    13,     5,
-       6,    13,     8,    14,    30,    31,    12,    13,    11,    14,
-       3,    30,    31,    18,    31,    30,    31,    13,    30,    31,
-      41,    42,    43,    44,    30,    31,    39,    40,    10,    34,
-      35,    16,    37,    17,    18,    45,    46,    21,    22,    23,
-      24,    13,    10,    10,    14,    14,    11,    11,    14,     7,
-      11
+       5,     6,    13,     8,    17,    18,    13,    12,    13,     5,
+       6,     3,     8,    19,    20,    31,    12,    13,    16,    30,
+      31,     0,    20,    30,    31,    30,    31,    64,    43,    44,
+      45,    46,    69,    13,    30,    31,    14,    11,    36,    37,
+       3,    39,    17,    18,    41,    42,    21,    22,    23,    24,
+      31,    10,    47,    48,    16,    13,    13,    10,    10,    14,
+      14,    11,     7,    14,     3,    65,    68
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,     3,    33,    34,    31,     0,    13,    14,    11,    35,
-       3,    36,    38,    31,     5,     6,     8,    12,    13,    30,
-      31,    37,    39,    40,    41,    42,    43,    44,    45,    46,
-      47,    48,    10,    41,    13,    13,    41,    16,    10,    17,
-      18,    21,    22,    23,    24,    19,    20,    10,    41,    41,
-      14,    41,    31,    45,    45,    44,    44,    44,    44,    46,
-      46,    14,    14,    11,    11,    36,    36,    12,    12,     7,
-      11,    36,    12
+       0,     3,    33,    34,    35,    31,     0,    35,    13,    14,
+      11,    36,     3,    37,    39,    31,     5,     6,     8,    12,
+      13,    30,    31,    38,    40,    41,    42,    43,    44,    45,
+      46,    47,    49,    50,    10,    42,    13,    13,    42,    16,
+      10,    17,    18,    21,    22,    23,    24,    19,    20,    10,
+      42,    42,    14,    42,    31,    46,    46,    45,    45,    45,
+      45,    47,    47,    14,    14,    11,    48,    48,    36,     7,
+      37,    48,    12
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    32,    33,    34,    35,    35,    36,    36,    37,    37,
-      37,    37,    38,    39,    40,    41,    42,    42,    43,    43,
-      43,    43,    43,    44,    44,    44,    45,    45,    45,    46,
-      46,    46,    47,    47,    48
+       0,    32,    33,    34,    34,    35,    36,    36,    37,    37,
+      38,    38,    38,    38,    39,    40,    41,    42,    43,    43,
+      44,    44,    44,    44,    44,    45,    45,    45,    46,    46,
+      46,    47,    47,    47,    48,    49,    49,    50
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
-       0,     2,     1,     8,     2,     0,     2,     0,     1,     1,
-       1,     1,     3,     3,     2,     1,     3,     1,     3,     3,
-       3,     3,     1,     3,     3,     1,     3,     3,     1,     1,
-       1,     3,     7,    11,     7
+       0,     2,     1,     2,     1,     8,     2,     0,     2,     0,
+       1,     1,     1,     1,     3,     3,     2,     1,     3,     1,
+       3,     3,     3,     3,     1,     3,     3,     1,     3,     3,
+       1,     1,     1,     3,     4,     5,     7,     5
 };
 
 
@@ -1156,208 +1154,226 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 2: /* program: function_declaration  */
-#line 69 "microc.y"
-                              { ast = (yyvsp[0].node); }
-#line 1163 "microc.tab.c"
+  case 2: /* program: functions  */
+#line 71 "microc.y"
+                   { ast = create_program_node((yyvsp[0].list)); }
+#line 1161 "microc.tab.c"
     break;
 
-  case 3: /* function_declaration: INT IDENTIFIER LPAR RPAR LBRACE declarations statements RBRACE  */
-#line 71 "microc.y"
+  case 3: /* functions: functions function_declaration  */
+#line 73 "microc.y"
+                                          { (yyval.list) = create_list_node((yyvsp[0].node), (yyvsp[-1].list)); }
+#line 1167 "microc.tab.c"
+    break;
+
+  case 4: /* functions: function_declaration  */
+#line 74 "microc.y"
+                                { (yyval.list) = create_list_node((yyvsp[0].node), NULL); }
+#line 1173 "microc.tab.c"
+    break;
+
+  case 5: /* function_declaration: INT IDENTIFIER LPAR RPAR LBRACE declarations statements RBRACE  */
+#line 76 "microc.y"
                                                                                      {
     (yyval.node) = create_function_node((yyvsp[-6].identifier), (yyvsp[-2].list), (yyvsp[-1].list));
 }
-#line 1171 "microc.tab.c"
+#line 1181 "microc.tab.c"
     break;
 
-  case 4: /* declarations: declarations declaration_statement  */
-#line 75 "microc.y"
+  case 6: /* declarations: declarations declaration_statement  */
+#line 80 "microc.y"
                                                  { (yyval.list) = create_list_node((yyvsp[0].node), (yyvsp[-1].list)); }
-#line 1177 "microc.tab.c"
+#line 1187 "microc.tab.c"
     break;
 
-  case 5: /* declarations: %empty  */
-#line 76 "microc.y"
+  case 7: /* declarations: %empty  */
+#line 81 "microc.y"
                           { (yyval.list) = NULL; }
-#line 1183 "microc.tab.c"
+#line 1193 "microc.tab.c"
     break;
 
-  case 6: /* statements: statements statement  */
-#line 78 "microc.y"
+  case 8: /* statements: statements statement  */
+#line 83 "microc.y"
                                  { (yyval.list) = create_list_node((yyvsp[0].node), (yyvsp[-1].list)); }
-#line 1189 "microc.tab.c"
+#line 1199 "microc.tab.c"
     break;
 
-  case 7: /* statements: %empty  */
-#line 79 "microc.y"
+  case 9: /* statements: %empty  */
+#line 84 "microc.y"
                         { (yyval.list) = NULL; }
-#line 1195 "microc.tab.c"
+#line 1205 "microc.tab.c"
     break;
 
-  case 8: /* statement: expression_statement  */
-#line 81 "microc.y"
+  case 10: /* statement: expression_statement  */
+#line 86 "microc.y"
                                 { (yyval.node) = (yyvsp[0].node); }
-#line 1201 "microc.tab.c"
+#line 1211 "microc.tab.c"
     break;
 
-  case 9: /* statement: if_statement  */
-#line 82 "microc.y"
+  case 11: /* statement: if_statement  */
+#line 87 "microc.y"
                         { (yyval.node) = (yyvsp[0].node); }
-#line 1207 "microc.tab.c"
+#line 1217 "microc.tab.c"
     break;
 
-  case 10: /* statement: while_statement  */
-#line 83 "microc.y"
+  case 12: /* statement: while_statement  */
+#line 88 "microc.y"
                            { (yyval.node) = (yyvsp[0].node); }
-#line 1213 "microc.tab.c"
+#line 1223 "microc.tab.c"
     break;
 
-  case 11: /* statement: return_statement  */
-#line 84 "microc.y"
+  case 13: /* statement: return_statement  */
+#line 89 "microc.y"
                             { (yyval.node) = (yyvsp[0].node); }
-#line 1219 "microc.tab.c"
+#line 1229 "microc.tab.c"
     break;
 
-  case 12: /* declaration_statement: INT IDENTIFIER SCOLON  */
-#line 86 "microc.y"
+  case 14: /* declaration_statement: INT IDENTIFIER SCOLON  */
+#line 91 "microc.y"
                                              { (yyval.node) = create_declaration_node((yyvsp[-1].identifier)); }
-#line 1225 "microc.tab.c"
+#line 1235 "microc.tab.c"
     break;
 
-  case 13: /* return_statement: RETURN expression SCOLON  */
-#line 88 "microc.y"
+  case 15: /* return_statement: RETURN expression SCOLON  */
+#line 93 "microc.y"
                                            { (yyval.node) = create_return_node((yyvsp[-1].node)); }
-#line 1231 "microc.tab.c"
+#line 1241 "microc.tab.c"
     break;
 
-  case 14: /* expression_statement: expression SCOLON  */
-#line 90 "microc.y"
+  case 16: /* expression_statement: expression SCOLON  */
+#line 95 "microc.y"
                                         { (yyval.node) = create_expr_stmt_node((yyvsp[-1].node)); }
-#line 1237 "microc.tab.c"
+#line 1247 "microc.tab.c"
     break;
 
-  case 15: /* expression: assignment_expression  */
-#line 92 "microc.y"
+  case 17: /* expression: assignment_expression  */
+#line 97 "microc.y"
                                   { (yyval.node) = (yyvsp[0].node); }
-#line 1243 "microc.tab.c"
+#line 1253 "microc.tab.c"
     break;
 
-  case 16: /* assignment_expression: IDENTIFIER ASG_OP expression  */
-#line 94 "microc.y"
+  case 18: /* assignment_expression: IDENTIFIER ASG_OP expression  */
+#line 99 "microc.y"
                                                     { (yyval.node) = create_assign_node((yyvsp[-2].identifier), (yyvsp[0].node)); }
-#line 1249 "microc.tab.c"
+#line 1259 "microc.tab.c"
     break;
 
-  case 17: /* assignment_expression: relational_expression  */
-#line 95 "microc.y"
+  case 19: /* assignment_expression: relational_expression  */
+#line 100 "microc.y"
                                              { (yyval.node) = (yyvsp[0].node); }
-#line 1255 "microc.tab.c"
+#line 1265 "microc.tab.c"
     break;
 
-  case 18: /* relational_expression: additive_expression EQ_OP additive_expression  */
-#line 97 "microc.y"
+  case 20: /* relational_expression: additive_expression EQ_OP additive_expression  */
+#line 102 "microc.y"
                                                                      { (yyval.node) = create_binary_op_node(NODE_EQUAL_OP, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1261 "microc.tab.c"
+#line 1271 "microc.tab.c"
     break;
 
-  case 19: /* relational_expression: additive_expression NOT_EQ_OP additive_expression  */
-#line 98 "microc.y"
+  case 21: /* relational_expression: additive_expression NOT_EQ_OP additive_expression  */
+#line 103 "microc.y"
                                                                          { (yyval.node) = create_binary_op_node(NODE_NOT_EQUAL_OP, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1267 "microc.tab.c"
+#line 1277 "microc.tab.c"
     break;
 
-  case 20: /* relational_expression: additive_expression LESS_THAN_OP additive_expression  */
-#line 99 "microc.y"
+  case 22: /* relational_expression: additive_expression LESS_THAN_OP additive_expression  */
+#line 104 "microc.y"
                                                                             { (yyval.node) = create_binary_op_node(NODE_LESS_THAN_OP, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1273 "microc.tab.c"
+#line 1283 "microc.tab.c"
     break;
 
-  case 21: /* relational_expression: additive_expression GREATER_THAN_OP additive_expression  */
-#line 100 "microc.y"
+  case 23: /* relational_expression: additive_expression GREATER_THAN_OP additive_expression  */
+#line 105 "microc.y"
                                                                                { (yyval.node) = create_binary_op_node(NODE_GREATER_THAN_OP, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1279 "microc.tab.c"
+#line 1289 "microc.tab.c"
     break;
 
-  case 22: /* relational_expression: additive_expression  */
-#line 101 "microc.y"
+  case 24: /* relational_expression: additive_expression  */
+#line 106 "microc.y"
                                            { (yyval.node) = (yyvsp[0].node); }
-#line 1285 "microc.tab.c"
+#line 1295 "microc.tab.c"
     break;
 
-  case 23: /* additive_expression: additive_expression PLUS multiplicative_expression  */
-#line 103 "microc.y"
+  case 25: /* additive_expression: additive_expression PLUS multiplicative_expression  */
+#line 108 "microc.y"
                                                                         { (yyval.node) = create_binary_op_node(NODE_PLUS, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1291 "microc.tab.c"
+#line 1301 "microc.tab.c"
     break;
 
-  case 24: /* additive_expression: additive_expression MINUS multiplicative_expression  */
-#line 104 "microc.y"
+  case 26: /* additive_expression: additive_expression MINUS multiplicative_expression  */
+#line 109 "microc.y"
                                                                          { (yyval.node) = create_binary_op_node(NODE_MINUS, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1297 "microc.tab.c"
+#line 1307 "microc.tab.c"
     break;
 
-  case 25: /* additive_expression: multiplicative_expression  */
-#line 105 "microc.y"
+  case 27: /* additive_expression: multiplicative_expression  */
+#line 110 "microc.y"
                                                { (yyval.node) = (yyvsp[0].node); }
-#line 1303 "microc.tab.c"
+#line 1313 "microc.tab.c"
     break;
 
-  case 26: /* multiplicative_expression: multiplicative_expression MULT primary_expression  */
-#line 107 "microc.y"
+  case 28: /* multiplicative_expression: multiplicative_expression MULT primary_expression  */
+#line 112 "microc.y"
                                                                              { (yyval.node) = create_binary_op_node(NODE_MULT, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1309 "microc.tab.c"
+#line 1319 "microc.tab.c"
     break;
 
-  case 27: /* multiplicative_expression: multiplicative_expression DIVIDE primary_expression  */
-#line 108 "microc.y"
+  case 29: /* multiplicative_expression: multiplicative_expression DIVIDE primary_expression  */
+#line 113 "microc.y"
                                                                                { (yyval.node) = create_binary_op_node(NODE_DIVIDE, (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1315 "microc.tab.c"
+#line 1325 "microc.tab.c"
     break;
 
-  case 28: /* multiplicative_expression: primary_expression  */
-#line 109 "microc.y"
+  case 30: /* multiplicative_expression: primary_expression  */
+#line 114 "microc.y"
                                               { (yyval.node) = (yyvsp[0].node); }
-#line 1321 "microc.tab.c"
+#line 1331 "microc.tab.c"
     break;
 
-  case 29: /* primary_expression: NUMBER  */
-#line 111 "microc.y"
+  case 31: /* primary_expression: NUMBER  */
+#line 116 "microc.y"
                            { (yyval.node) = create_number_node((yyvsp[0].number)); }
-#line 1327 "microc.tab.c"
+#line 1337 "microc.tab.c"
     break;
 
-  case 30: /* primary_expression: IDENTIFIER  */
-#line 112 "microc.y"
+  case 32: /* primary_expression: IDENTIFIER  */
+#line 117 "microc.y"
                                { (yyval.node) = create_identifier_node((yyvsp[0].identifier)); }
-#line 1333 "microc.tab.c"
+#line 1343 "microc.tab.c"
     break;
 
-  case 31: /* primary_expression: LPAR expression RPAR  */
-#line 113 "microc.y"
+  case 33: /* primary_expression: LPAR expression RPAR  */
+#line 118 "microc.y"
                                          { (yyval.node) = (yyvsp[-1].node); }
-#line 1339 "microc.tab.c"
+#line 1349 "microc.tab.c"
     break;
 
-  case 32: /* if_statement: IF LPAR expression RPAR LBRACE statements RBRACE  */
-#line 115 "microc.y"
-                                                               { (yyval.node) = create_if_node((yyvsp[-4].node), (yyvsp[-1].list), NULL); }
-#line 1345 "microc.tab.c"
+  case 34: /* block: LBRACE declarations statements RBRACE  */
+#line 121 "microc.y"
+                                             { (yyval.list) = create_block_list((yyvsp[-2].list), (yyvsp[-1].list)); }
+#line 1355 "microc.tab.c"
     break;
 
-  case 33: /* if_statement: IF LPAR expression RPAR LBRACE statements RBRACE ELSE LBRACE statements RBRACE  */
-#line 116 "microc.y"
-                                                                                             { (yyval.node) = create_if_node((yyvsp[-8].node), (yyvsp[-5].list), (yyvsp[-1].list)); }
-#line 1351 "microc.tab.c"
+  case 35: /* if_statement: IF LPAR expression RPAR block  */
+#line 123 "microc.y"
+                                            { (yyval.node) = create_if_node((yyvsp[-2].node), (yyvsp[0].list), NULL); }
+#line 1361 "microc.tab.c"
     break;
 
-  case 34: /* while_statement: WHILE LPAR expression RPAR LBRACE statements RBRACE  */
-#line 118 "microc.y"
-                                                                     { (yyval.node) = create_while_node((yyvsp[-4].node), (yyvsp[-1].list)); }
-#line 1357 "microc.tab.c"
+  case 36: /* if_statement: IF LPAR expression RPAR block ELSE block  */
+#line 124 "microc.y"
+                                                       { (yyval.node) = create_if_node((yyvsp[-4].node), (yyvsp[-2].list), (yyvsp[0].list)); }
+#line 1367 "microc.tab.c"
     break;
 
+  case 37: /* while_statement: WHILE LPAR expression RPAR block  */
+#line 126 "microc.y"
+                                                  { (yyval.node) = create_while_node((yyvsp[-2].node), (yyvsp[0].list)); }
+#line 1373 "microc.tab.c"
+    break;
 
-#line 1361 "microc.tab.c"
+
+#line 1377 "microc.tab.c"
 
       default: break;
     }
@@ -1550,7 +1566,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 120 "microc.y"
+#line 128 "microc.y"
 
 
 void yyerror(const char *s) {
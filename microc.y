@@ -63,10 +63,15 @@ extern int yylex();
 %type<node> return_statement
 %type<list> declarations
 %type<list> statements
+%type<list> block
+%type<list> functions
 
 %% //regole grammaticali
 
-program: function_declaration { ast = $1; };
+program: functions { ast = create_program_node($1); };
+
+functions: functions function_declaration { $$ = create_list_node($2, $1); }
+         | function_declaration { $$ = create_list_node($1, NULL); };
 
 function_declaration: INT IDENTIFIER LPAR RPAR LBRACE declarations statements RBRACE {
     $$ = create_function_node($2, $6, $7);
@@ -112,10 +117,13 @@ primary_expression: NUMBER { $$ = create_number_node($1); }
                   | IDENTIFIER { $$ = create_identifier_node($1); }
                   | LPAR expression RPAR { $$ = $2; };
 
-if_statement: IF LPAR expression RPAR LBRACE statements RBRACE { $$ = create_if_node($3, $6, NULL); }
-            | IF LPAR expression RPAR LBRACE statements RBRACE ELSE LBRACE statements RBRACE { $$ = create_if_node($3, $6, $10); };
+// Un blocco può aprirsi con delle dichiarazioni, visibili solo al suo interno
+block: LBRACE declarations statements RBRACE { $$ = create_block_list($2, $3); };
+
+if_statement: IF LPAR expression RPAR block { $$ = create_if_node($3, $5, NULL); }
+            | IF LPAR expression RPAR block ELSE block { $$ = create_if_node($3, $5, $7); };
 
-while_statement: WHILE LPAR expression RPAR LBRACE statements RBRACE { $$ = create_while_node($3, $6); };
+while_statement: WHILE LPAR expression RPAR block { $$ = create_while_node($3, $5); };
 
 %%
 
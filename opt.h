@@ -0,0 +1,38 @@
+#ifndef OPT_H
+#define OPT_H
+
+#include "ir.h"
+
+// Passi di ottimizzazione sull'IR in forma SSA, attivi da -O1.
+// Ogni passo lascia valide le analisi di cfg.c solo se non tocca blocchi e archi;
+// chi cambia il grafo richiama cfg_build prima di terminare.
+
+// Piegatura e propagazione delle costanti, propagazione delle copie (fold.c)
+void opt_fold_constants(IrFunction* fn);
+void opt_propagate_copies(IrFunction* fn);
+
+// Semplificazione algebrica: identità, costanti a destra, riassociazione delle costanti (simplify.c)
+void opt_simplify(IrFunction* fn);
+
+// Propagazione sparsa condizionale delle costanti, con potatura dei rami mai eseguiti (sccp.c)
+void opt_sccp(IrFunction* fn);
+
+// Numerazione globale dei valori: elimina le sottoespressioni comuni (gvn.c)
+void opt_value_numbering(IrFunction* fn);
+
+// Spostamento del codice invariante dei cicli nel preheader (licm.c)
+void opt_hoist_invariants(IrFunction* fn);
+
+// Variabili di induzione: moltiplicazioni sostituite da incrementi, test di uscita riscritti (iv.c)
+void opt_reduce_strength(IrFunction* fn);
+
+// Srotolamento dei cicli più interni, completo o con un ciclo di resto (unroll.c)
+void opt_unroll_loops(IrFunction* fn, int factor);
+
+// Rotazione dei while in do-while protetti, con il test in fondo al corpo (rotate.c)
+void opt_rotate_loops(IrFunction* fn);
+
+// Eliminazione delle istruzioni il cui risultato non serve (dce.c)
+void opt_dead_code(IrFunction* fn);
+
+#endif // OPT_H
@@ -0,0 +1,450 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asm.h"
+
+// Ottimizzazione a finestra sull'assembly di una funzione.
+// Il backend traduce ogni istruzione IR da sola: carica gli operandi dagli slot in EAX, calcola
+// e rimette il risultato nello slot, anche quando l'istruzione successiva lo ricarica subito.
+// I passi, ripetuti finché cambiano qualcosa:
+//
+//   - inoltro degli slot: in un tratto senza etichette si ricorda quale registro ha una copia di
+//     quale slot; la rilettura dello slot si toglie o diventa una copia tra registri, le altre
+//     letture dello slot leggono il registro;
+//   - slot costanti: uno slot scritto una sola volta con "movl $k" si legge come immediato;
+//   - scritture morte: "movl x, slot" su uno slot che nessuna istruzione legge si toglie;
+//   - istruzioni singole: "movl $0, %r" diventa "xorl %r, %r" se i flag non servono, "cmpl $0, %r"
+//     diventa "testl %r, %r", che sparisce se i flag li ha già impostati l'operazione che ha
+//     calcolato %r e si guarda solo ZF; copie di un registro su se stesso e salti all'etichetta
+//     successiva si tolgono.
+//
+// Tutti gli accessi alla memoria sono slot del frame, "N(%ebp)" oppure "N(%esp)" se il backend omette
+// il frame pointer (una sola base per funzione): il linguaggio non ha puntatori.
+// I flag non sono mai vivi attraverso un'etichetta: ogni jcc segue il suo confronto nello stesso blocco.
+
+enum { REG_EAX, REG_ECX, REG_EDX, REG_EBX, REG_ESP, REG_EBP, REG_ESI, REG_EDI, NREGS };
+
+static const char* register_names[NREGS][3] = {
+    { "%eax", "%ax", "%al" }, { "%ecx", "%cx", "%cl" }, { "%edx", "%dx", "%dl" }, { "%ebx", "%bx", "%bl" },
+    { "%esp", "%sp", NULL }, { "%ebp", "%bp", NULL }, { "%esi", "%si", NULL }, { "%edi", "%di", NULL }
+};
+
+// Registro (intero o parziale) indicato dall'operando, -1 se non è un registro.
+static int register_index(const char* operand) {
+    for (int r = 0; r < NREGS; r++) {
+        for (int w = 0; w < 3; w++) {
+            if (register_names[r][w] && strcmp(operand, register_names[r][w]) == 0) return r;
+        }
+    }
+    return -1;
+}
+
+static int is_register32(const char* operand) {
+    int r = register_index(operand);
+    return r >= 0 && strcmp(operand, register_names[r][0]) == 0;
+}
+
+static int is_memory(const char* operand) {
+    return strchr(operand, '(') != NULL;
+}
+
+static int is_immediate(const char* operand) {
+    return operand[0] == '$';
+}
+
+// Registri usati per calcolare l'indirizzo di un operando in memoria.
+static unsigned address_registers(const char* operand) {
+    unsigned mask = 0;
+    for (const char* p = strchr(operand, '%'); p; p = strchr(p + 1, '%')) {
+        char name[5];
+        int length = 0;
+        while (length < 4 && p[length]) {
+            name[length] = p[length];
+            length++;
+        }
+        name[length] = '\0';
+        int r = register_index(name);
+        if (r >= 0) mask |= 1u << r;
+    }
+    return mask;
+}
+
+typedef struct {
+    int known;                          // mnemonico conosciuto: altrimenti si assume il peggio
+    unsigned reads;                     // registri letti, anche per calcolare indirizzi
+    unsigned writes;                    // registri scritti
+    int read_operand[ASM_MAX_OPERANDS];
+    int write_operand[ASM_MAX_OPERANDS];
+    int sets_flags;
+    int uses_flags;
+    int control;                        // salto o ritorno
+} Effects;
+
+static int has_prefix(const char* s, const char* prefix) {
+    return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+static int in_list(const char* mnemonic, const char* const* list) {
+    for (int i = 0; list[i]; i++) {
+        if (strcmp(mnemonic, list[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+static const char* const alu_ops[] = { "addl", "subl", "andl", "orl", "xorl", "shll", "sarl", "shrl", NULL };
+static const char* const unary_ops[] = { "negl", "notl", "incl", "decl", NULL };
+
+static void access_operand(AsmInsn* insn, Effects* e, int k, int read, int write) {
+    const char* operand = insn->operands[k];
+    int r = register_index(operand);
+    if (r >= 0) {
+        if (read) e->reads |= 1u << r;
+        if (write) e->writes |= 1u << r;
+        // La scrittura di un registro parziale conserva il resto: è anche una lettura
+        if (write && !is_register32(operand)) e->reads |= 1u << r;
+    } else if (is_memory(operand)) {
+        e->reads |= address_registers(operand);
+    }
+    e->read_operand[k] = read;
+    e->write_operand[k] = write;
+}
+
+static void compute_effects(AsmInsn* insn, Effects* e) {
+    memset(e, 0, sizeof(Effects));
+    const char* m = insn->mnemonic;
+    int n = insn->noperands;
+    e->known = 1;
+    if ((strcmp(m, "movl") == 0 || strcmp(m, "movzbl") == 0) && n == 2) {
+        access_operand(insn, e, 0, 1, 0);
+        access_operand(insn, e, 1, 0, 1);
+    } else if (strcmp(m, "leal") == 0 && n == 2) {
+        // L'indirizzo si calcola soltanto: nessun accesso alla memoria
+        e->reads |= address_registers(insn->operands[0]);
+        access_operand(insn, e, 1, 0, 1);
+    } else if (in_list(m, alu_ops) && n == 2) {
+        access_operand(insn, e, 0, 1, 0);
+        access_operand(insn, e, 1, 1, 1);
+        e->sets_flags = 1;
+    } else if ((strcmp(m, "cmpl") == 0 || strcmp(m, "testl") == 0) && n == 2) {
+        access_operand(insn, e, 0, 1, 0);
+        access_operand(insn, e, 1, 1, 0);
+        e->sets_flags = 1;
+    } else if (in_list(m, unary_ops) && n == 1) {
+        access_operand(insn, e, 0, 1, 1);
+        e->sets_flags = strcmp(m, "notl") != 0;
+    } else if (strcmp(m, "imull") == 0 && n == 3) {
+        access_operand(insn, e, 0, 1, 0);
+        access_operand(insn, e, 1, 1, 0);
+        access_operand(insn, e, 2, 0, 1);
+        e->sets_flags = 1;
+    } else if (strcmp(m, "imull") == 0 && n == 2) {
+        access_operand(insn, e, 0, 1, 0);
+        access_operand(insn, e, 1, 1, 1);
+        e->sets_flags = 1;
+    } else if ((strcmp(m, "imull") == 0 || strcmp(m, "idivl") == 0) && n == 1) {
+        // EDX:EAX = EAX * op, oppure EAX = EDX:EAX / op e EDX = resto
+        access_operand(insn, e, 0, 1, 0);
+        e->reads |= (1u << REG_EAX) | (strcmp(m, "idivl") == 0 ? 1u << REG_EDX : 0);
+        e->writes |= (1u << REG_EAX) | (1u << REG_EDX);
+        e->sets_flags = 1;
+    } else if (strcmp(m, "cdq") == 0 && n == 0) {
+        e->reads |= 1u << REG_EAX;
+        e->writes |= 1u << REG_EDX;
+    } else if (has_prefix(m, "set") && n == 1) {
+        access_operand(insn, e, 0, 0, 1);
+        e->uses_flags = 1;
+    } else if (strcmp(m, "pushl") == 0 && n == 1) {
+        access_operand(insn, e, 0, 1, 0);
+        e->reads |= 1u << REG_ESP;
+        e->writes |= 1u << REG_ESP;
+    } else if (strcmp(m, "popl") == 0 && n == 1) {
+        access_operand(insn, e, 0, 0, 1);
+        e->reads |= 1u << REG_ESP;
+        e->writes |= 1u << REG_ESP;
+    } else if (strcmp(m, "ret") == 0 && n == 0) {
+        e->reads |= 1u << REG_EAX;
+        e->control = 1;
+    } else if (m[0] == 'j' && n == 1) {
+        e->uses_flags = strcmp(m, "jmp") != 0;
+        e->control = 1;
+    } else {
+        e->known = 0;
+    }
+}
+
+static int is_jump(AsmInsn* insn) {
+    return insn->kind == ASM_INSN && strcmp(insn->mnemonic, "jmp") == 0;
+}
+
+static void delete_insn(AsmInsn* insn) {
+    insn->deleted = 1;
+}
+
+// Inoltro degli slot: mirror[r] è lo slot di cui il registro r contiene il valore.
+static int forward_slots(AsmBuffer* buffer) {
+    char mirror[NREGS][ASM_OPERAND_LEN];
+    int changed = 0;
+    memset(mirror, 0, sizeof(mirror));
+    for (int i = 0; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind == ASM_DIRECTIVE) continue;
+        if (insn->kind == ASM_LABEL) {
+            memset(mirror, 0, sizeof(mirror));
+            continue;
+        }
+        Effects e;
+        compute_effects(insn, &e);
+        if (!e.known) {
+            memset(mirror, 0, sizeof(mirror));
+            continue;
+        }
+        int is_move = strcmp(insn->mnemonic, "movl") == 0;
+        if (is_move && is_memory(insn->operands[0]) && is_register32(insn->operands[1]) &&
+            strcmp(mirror[register_index(insn->operands[1])], insn->operands[0]) == 0) {
+            delete_insn(insn);
+            changed = 1;
+            continue;
+        }
+        // Gli slot letti (e non scritti) con una copia in un registro si leggono dal registro
+        if (strcmp(insn->mnemonic, "movzbl") != 0) {
+            for (int k = 0; k < insn->noperands; k++) {
+                if (!e.read_operand[k] || e.write_operand[k] || !is_memory(insn->operands[k])) continue;
+                for (int r = 0; r < NREGS; r++) {
+                    if (strcmp(mirror[r], insn->operands[k]) == 0) {
+                        strcpy(insn->operands[k], register_names[r][0]);
+                        changed = 1;
+                        break;
+                    }
+                }
+            }
+            compute_effects(insn, &e);
+        }
+
+        for (int r = 0; r < NREGS; r++) {
+            if (e.writes & (1u << r)) mirror[r][0] = '\0';
+        }
+        // Se cambia la base dello slot, il registro non ne è più una copia
+        for (int r = 0; r < NREGS; r++) {
+            if (mirror[r][0] && (address_registers(mirror[r]) & e.writes)) mirror[r][0] = '\0';
+        }
+        for (int k = 0; k < insn->noperands; k++) {
+            if (!e.write_operand[k] || !is_memory(insn->operands[k])) continue;
+            for (int r = 0; r < NREGS; r++) {
+                if (strcmp(mirror[r], insn->operands[k]) == 0) mirror[r][0] = '\0';
+            }
+        }
+        if (is_move) {
+            const char* src = insn->operands[0];
+            const char* dst = insn->operands[1];
+            if (is_register32(src) && is_memory(dst)) {
+                strcpy(mirror[register_index(src)], dst);
+            } else if (is_memory(src) && is_register32(dst)) {
+                strcpy(mirror[register_index(dst)], src);
+            } else if (is_register32(src) && is_register32(dst) && register_index(src) != register_index(dst)) {
+                memcpy(mirror[register_index(dst)], mirror[register_index(src)], ASM_OPERAND_LEN);
+            }
+        }
+        if (e.control && !e.uses_flags) memset(mirror, 0, sizeof(mirror));
+    }
+    return changed;
+}
+
+// Offset N dello slot "N(%ebp)" o "N(%esp)"; 0 per gli altri operandi, per esempio "4(%ebx)".
+static int parse_slot(const char* operand, int* offset) {
+    int length = -1;
+    if (sscanf(operand, "%d(%n", offset, &length) != 1 || length < 0) return 0;
+    return strcmp(operand + length, "%ebp)") == 0 || strcmp(operand + length, "%esp)") == 0;
+}
+
+// Indice dello slot nelle tabelle per slot, -1 per gli altri operandi.
+static int slot_index(const char* operand, int min_offset) {
+    int offset;
+    if (!parse_slot(operand, &offset)) return -1;
+    return offset - min_offset;
+}
+
+// Intervallo degli offset degli slot. Restituisce 0 se c'è un accesso alla memoria non riconosciuto.
+static int slot_range(AsmBuffer* buffer, int* min_offset, int* nslots) {
+    int low = 0, high = -1;
+    for (int i = 0; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind != ASM_INSN || strcmp(insn->mnemonic, "leal") == 0) continue;
+        for (int k = 0; k < insn->noperands; k++) {
+            if (!is_memory(insn->operands[k])) continue;
+            int offset;
+            if (!parse_slot(insn->operands[k], &offset)) {
+                return 0;
+            }
+            if (high < low) {
+                low = high = offset;
+            } else {
+                if (offset < low) low = offset;
+                if (offset > high) high = offset;
+            }
+        }
+    }
+    *min_offset = low;
+    *nslots = high - low + 1;
+    return 1;
+}
+
+// Letture e scritture di ogni slot; const_write[s] è l'istruzione "movl $k, slot" se è l'unica scrittura.
+static void count_slot_accesses(AsmBuffer* buffer, int min_offset, int* reads, int* writes, int* const_write) {
+    for (int i = 0; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind != ASM_INSN) continue;
+        Effects e;
+        compute_effects(insn, &e);
+        for (int k = 0; k < insn->noperands; k++) {
+            int s = strcmp(insn->mnemonic, "leal") == 0 ? -1 : slot_index(insn->operands[k], min_offset);
+            if (s < 0) continue;
+            if (!e.known || e.read_operand[k]) reads[s]++;
+            if (!e.known || e.write_operand[k]) {
+                writes[s]++;
+                const_write[s] = strcmp(insn->mnemonic, "movl") == 0 && is_immediate(insn->operands[0]) ? i : -1;
+            }
+        }
+    }
+}
+
+static void* peephole_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione dell'ottimizzazione a finestra");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Slot costanti letti come immediati, poi scritture su slot mai letti.
+static int optimize_slots(AsmBuffer* buffer) {
+    static const char* const immediate_sources[] = { "movl", "addl", "subl", "andl", "orl", "xorl", "cmpl", "pushl", NULL };
+    int min_offset, nslots;
+    if (!slot_range(buffer, &min_offset, &nslots)) return 0;
+    int* reads = (int*)peephole_alloc((size_t)nslots, sizeof(int));
+    int* writes = (int*)peephole_alloc((size_t)nslots, sizeof(int));
+    int* const_write = (int*)peephole_alloc((size_t)nslots, sizeof(int));
+    int changed = 0;
+
+    count_slot_accesses(buffer, min_offset, reads, writes, const_write);
+    for (int i = 0; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind != ASM_INSN || insn->noperands == 0) continue;
+        int two_operand_imull = strcmp(insn->mnemonic, "imull") == 0 && insn->noperands == 2;
+        if (!in_list(insn->mnemonic, immediate_sources) && !two_operand_imull) continue;
+        int s = slot_index(insn->operands[0], min_offset);
+        if (s < 0 || writes[s] != 1 || const_write[s] < 0 || const_write[s] == i) continue;
+        strcpy(insn->operands[0], buffer->insns[const_write[s]].operands[0]);
+        reads[s]--;
+        changed = 1;
+    }
+    for (int i = 0; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind != ASM_INSN || strcmp(insn->mnemonic, "movl") != 0) continue;
+        int s = slot_index(insn->operands[1], min_offset);
+        if (s >= 0 && reads[s] == 0) {
+            delete_insn(insn);
+            changed = 1;
+        }
+    }
+    free(reads);
+    free(writes);
+    free(const_write);
+    return changed;
+}
+
+// Vero se i flag impostati prima dell'istruzione start non vengono più letti.
+static int flags_dead_from(AsmBuffer* buffer, int start) {
+    for (int i = start; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind == ASM_DIRECTIVE) continue;
+        if (insn->kind == ASM_LABEL) return 1;
+        Effects e;
+        compute_effects(insn, &e);
+        if (!e.known || e.uses_flags) return 0;
+        if (e.sets_flags || e.control) return 1;
+    }
+    return 1;
+}
+
+// Vero se chi legge i flag prima della prossima istruzione che li imposta guarda solo ZF.
+static int only_zero_flag_used_from(AsmBuffer* buffer, int start) {
+    static const char* const zero_flag_users[] = { "je", "jne", "jz", "jnz", "sete", "setne", NULL };
+    for (int i = start; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind == ASM_DIRECTIVE) continue;
+        if (insn->kind == ASM_LABEL) return 1;
+        Effects e;
+        compute_effects(insn, &e);
+        if (!e.known) return 0;
+        if (e.uses_flags && !in_list(insn->mnemonic, zero_flag_users)) return 0;
+        if (e.sets_flags || (e.control && !e.uses_flags)) return 1;
+    }
+    return 1;
+}
+
+// "testl %r, %r" è superfluo se l'ultima istruzione che ha impostato i flag ha calcolato %r.
+static int test_is_redundant(AsmBuffer* buffer, int index) {
+    static const char* const result_flag_ops[] = { "addl", "subl", "andl", "orl", "xorl", "negl", "incl", "decl", NULL };
+    int r = register_index(buffer->insns[index].operands[0]);
+    for (int i = index - 1; i >= 0; i--) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind == ASM_DIRECTIVE) continue;
+        if (insn->kind == ASM_LABEL) return 0;
+        Effects e;
+        compute_effects(insn, &e);
+        if (!e.known || e.control) return 0;
+        if (e.sets_flags) {
+            return in_list(insn->mnemonic, result_flag_ops) &&
+                   strcmp(insn->operands[insn->noperands - 1], register_names[r][0]) == 0;
+        }
+        if (e.writes & (1u << r)) return 0;
+    }
+    return 0;
+}
+
+static int simplify_instructions(AsmBuffer* buffer) {
+    int changed = 0;
+    for (int i = 0; i < buffer->count; i++) {
+        AsmInsn* insn = &buffer->insns[i];
+        if (insn->deleted || insn->kind != ASM_INSN) continue;
+        const char* m = insn->mnemonic;
+        if (strcmp(m, "movl") == 0 && strcmp(insn->operands[0], insn->operands[1]) == 0) {
+            delete_insn(insn);
+            changed = 1;
+        } else if (strcmp(m, "movl") == 0 && strcmp(insn->operands[0], "$0") == 0 &&
+                   is_register32(insn->operands[1]) && flags_dead_from(buffer, i + 1)) {
+            strcpy(insn->mnemonic, "xorl");
+            strcpy(insn->operands[0], insn->operands[1]);
+            changed = 1;
+        } else if (strcmp(m, "cmpl") == 0 && strcmp(insn->operands[0], "$0") == 0 && is_register32(insn->operands[1])) {
+            strcpy(insn->mnemonic, "testl");
+            strcpy(insn->operands[0], insn->operands[1]);
+            changed = 1;
+        } else if (strcmp(m, "testl") == 0 && strcmp(insn->operands[0], insn->operands[1]) == 0 &&
+                   is_register32(insn->operands[0]) && test_is_redundant(buffer, i) &&
+                   only_zero_flag_used_from(buffer, i + 1)) {
+            delete_insn(insn);
+            changed = 1;
+        } else if (is_jump(insn)) {
+            int j = i + 1;
+            while (j < buffer->count && (buffer->insns[j].deleted || buffer->insns[j].kind == ASM_DIRECTIVE)) j++;
+            if (j < buffer->count && buffer->insns[j].kind == ASM_LABEL &&
+                strcmp(buffer->insns[j].operands[0], insn->operands[0]) == 0) {
+                delete_insn(insn);
+                changed = 1;
+            }
+        }
+    }
+    return changed;
+}
+
+void asm_peephole(AsmBuffer* buffer) {
+    int changed = 1;
+    while (changed) {
+        changed = forward_slots(buffer);
+        changed |= optimize_slots(buffer);
+        changed |= simplify_instructions(buffer);
+        asm_compact(buffer);
+    }
+}
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+#include "regalloc.h"
+
+// Allocazione a scansione lineare.
+// Le istruzioni si numerano nell'ordine di emissione: l'istruzione i legge i suoi operandi alla
+// posizione 2i e scrive il risultato alla 2i + 1, così un operando che muore in i lascia il
+// registro libero per il risultato della stessa istruzione. L'intervallo di un registro virtuale
+// va dalla prima all'ultima posizione in cui è vivo: oltre a definizioni e usi comprende i blocchi
+// in cui è vivo all'ingresso o all'uscita (analisi di vitalità all'indietro sul grafo).
+//
+// Gli intervalli si visitano per inizio crescente; quando non c'è un registro libero si lascia in
+// memoria l'intervallo, tra quello corrente e gli attivi, con il peso minore. Ogni definizione e
+// uso costa 10^profondità del ciclo, così i contatori dei cicli interni restano nei registri;
+// il peso è il costo diviso per la lunghezza dell'intervallo, perché un valore usato poco ma vivo
+// a lungo occupa il registro che servirebbe a molti temporanei.
+
+const char* const regalloc_names[REGALLOC_NREGS] = { "%ebx", "%ecx", "%esi", "%edi", "%ebp" };
+
+typedef struct {
+    int vreg;
+    int start;
+    int end;
+    double cost;
+    double weight;
+    int reg;
+} Interval;
+
+static void* regalloc_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione dei registri");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static int bit_test(const unsigned* set, int v) {
+    return (set[v / 32] >> (v % 32)) & 1u;
+}
+
+static void bit_set(unsigned* set, int v) {
+    set[v / 32] |= 1u << (v % 32);
+}
+
+unsigned* regalloc_live_out(IrFunction* fn, int words) {
+    int n = fn->nblocks;
+    unsigned* use = (unsigned*)regalloc_alloc((size_t)n * words, sizeof(unsigned));
+    unsigned* def = (unsigned*)regalloc_alloc((size_t)n * words, sizeof(unsigned));
+    unsigned* live_in = (unsigned*)regalloc_alloc((size_t)n * words, sizeof(unsigned));
+    unsigned* live_out = (unsigned*)regalloc_alloc((size_t)n * words, sizeof(unsigned));
+    int* index = (int*)regalloc_alloc((size_t)fn->next_block_id, sizeof(int));
+
+    for (int b = 0; b < n; b++) {
+        IrBlock* block = fn->blocks[b];
+        index[block->id] = b;
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            int count = ir_operand_count(insn);
+            for (int k = 0; k < count; k++) {
+                int v = *ir_operand(insn, k);
+                if (!bit_test(&def[b * words], v)) bit_set(&use[b * words], v);
+            }
+            if (insn->dst) bit_set(&def[b * words], insn->dst);
+        }
+    }
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int b = n - 1; b >= 0; b--) {
+            IrBlock* block = fn->blocks[b];
+            unsigned* out = &live_out[b * words];
+            for (int s = 0; s < block->nsucc; s++) {
+                unsigned* succ_in = &live_in[index[block->succ[s]->id] * words];
+                for (int w = 0; w < words; w++) out[w] |= succ_in[w];
+            }
+            unsigned* in = &live_in[b * words];
+            for (int w = 0; w < words; w++) {
+                unsigned value = use[b * words + w] | (out[w] & ~def[b * words + w]);
+                if (value != in[w]) {
+                    in[w] = value;
+                    changed = 1;
+                }
+            }
+        }
+    }
+    free(use);
+    free(def);
+    free(live_in);
+    free(index);
+    return live_out;
+}
+
+static void extend(Interval* interval, int position) {
+    if (interval->start < 0 || position < interval->start) interval->start = position;
+    if (position > interval->end) interval->end = position;
+}
+
+static int compare_start(const void* x, const void* y) {
+    const Interval* a = *(const Interval* const*)x;
+    const Interval* b = *(const Interval* const*)y;
+    if (a->start != b->start) return a->start < b->start ? -1 : 1;
+    return a->vreg - b->vreg;
+}
+
+// Intervallo di vita e costo di ogni registro virtuale (start = -1 se non compare mai).
+static Interval* build_intervals(IrFunction* fn) {
+    int nvregs = fn->nvregs;
+    int words = nvregs / 32 + 1;
+    unsigned* live_out = regalloc_live_out(fn, words);
+    Interval* intervals = (Interval*)regalloc_alloc((size_t)nvregs + 1, sizeof(Interval));
+    for (int v = 0; v <= nvregs; v++) {
+        intervals[v].vreg = v;
+        intervals[v].start = -1;
+        intervals[v].end = -1;
+        intervals[v].reg = -1;
+    }
+
+    // Intervalli e costi. Per ogni blocco si estendono anche gli intervalli vivi all'uscita
+    // (fino all'ultima posizione) e, all'indietro, quelli usati prima di essere definiti.
+    int position = 0;
+    for (int b = 0; b < fn->nblocks; b++) {
+        IrBlock* block = fn->blocks[b];
+        int first = position;
+        int last = position + 2 * block->ninsns - 1;
+        double weight = 1;
+        for (int d = 0; d < block->loop_depth; d++) weight *= 10;
+
+        unsigned* defined = (unsigned*)regalloc_alloc((size_t)words, sizeof(unsigned));
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            int count = ir_operand_count(insn);
+            for (int k = 0; k < count; k++) {
+                int v = *ir_operand(insn, k);
+                if (!bit_test(defined, v)) extend(&intervals[v], first);
+                extend(&intervals[v], position);
+                intervals[v].cost += weight;
+            }
+            if (insn->dst) {
+                extend(&intervals[insn->dst], position + 1);
+                intervals[insn->dst].cost += weight;
+                bit_set(defined, insn->dst);
+            }
+            position += 2;
+        }
+        for (int v = 1; v <= nvregs; v++) {
+            if (bit_test(&live_out[b * words], v)) {
+                extend(&intervals[v], first);
+                extend(&intervals[v], last);
+            }
+        }
+        free(defined);
+    }
+    free(live_out);
+    return intervals;
+}
+
+// Intervalli dei registri selezionati da wanted, ordinati per inizio crescente.
+static Interval** sorted_intervals(IrFunction* fn, Interval* intervals, const char* wanted, int* count) {
+    Interval** order = (Interval**)regalloc_alloc((size_t)fn->nvregs + 1, sizeof(Interval*));
+    *count = 0;
+    for (int v = 1; v <= fn->nvregs; v++) {
+        if (wanted[v] && intervals[v].start >= 0) order[(*count)++] = &intervals[v];
+    }
+    qsort(order, (size_t)*count, sizeof(Interval*), compare_start);
+    return order;
+}
+
+int* regalloc_linear_scan(IrFunction* fn, const char* candidate) {
+    int nvregs = fn->nvregs;
+    Interval* intervals = build_intervals(fn);
+    int count;
+    Interval** order = sorted_intervals(fn, intervals, candidate, &count);
+    for (int i = 0; i < count; i++) order[i]->weight = order[i]->cost / (order[i]->end - order[i]->start + 1);
+
+    // Intervalli attivi, ordinati per fine crescente
+    Interval* active[REGALLOC_NREGS];
+    int nactive = 0;
+    unsigned free_regs = (1u << REGALLOC_NREGS) - 1;
+    for (int i = 0; i < count; i++) {
+        Interval* current = order[i];
+        int kept = 0;
+        for (int a = 0; a < nactive; a++) {
+            if (active[a]->end < current->start) {
+                free_regs |= 1u << active[a]->reg;
+            } else {
+                active[kept++] = active[a];
+            }
+        }
+        nactive = kept;
+
+        if (free_regs == 0) {
+            // Si rinuncia all'intervallo con il peso minore; a parità di peso a quello che finisce dopo
+            int victim = -1;
+            for (int a = 0; a < nactive; a++) {
+                if (victim < 0 || active[a]->weight < active[victim]->weight ||
+                    (active[a]->weight == active[victim]->weight && active[a]->end > active[victim]->end)) {
+                    victim = a;
+                }
+            }
+            if (current->weight < active[victim]->weight ||
+                (current->weight == active[victim]->weight && current->end >= active[victim]->end)) {
+                continue;
+            }
+            free_regs |= 1u << active[victim]->reg;
+            active[victim]->reg = -1;
+            for (int a = victim; a + 1 < nactive; a++) active[a] = active[a + 1];
+            nactive--;
+        }
+
+        int reg = 0;
+        while (!(free_regs & (1u << reg))) reg++;
+        free_regs &= ~(1u << reg);
+        current->reg = reg;
+        int at = nactive;
+        while (at > 0 && active[at - 1]->end > current->end) {
+            active[at] = active[at - 1];
+            at--;
+        }
+        active[at] = current;
+        nactive++;
+    }
+
+    int* assignment = (int*)regalloc_alloc((size_t)nvregs + 1, sizeof(int));
+    for (int v = 0; v <= nvregs; v++) assignment[v] = intervals[v].reg;
+    free(order);
+    free(intervals);
+    return assignment;
+}
+
+int* regalloc_share_slots(IrFunction* fn, const char* in_memory, int* nslots) {
+    Interval* intervals = build_intervals(fn);
+    int count;
+    Interval** order = sorted_intervals(fn, intervals, in_memory, &count);
+    int* slot = (int*)regalloc_alloc((size_t)fn->nvregs + 1, sizeof(int));
+    for (int v = 0; v <= fn->nvregs; v++) slot[v] = -1;
+
+    // Come la scansione lineare ma con slot illimitati: uno slot torna libero quando finisce
+    // l'intervallo che lo occupa, e si riusa per primo il più basso.
+    Interval** active = (Interval**)regalloc_alloc((size_t)count, sizeof(Interval*));
+    char* busy = (char*)regalloc_alloc((size_t)count, 1);
+    int nactive = 0;
+    *nslots = 0;
+    for (int i = 0; i < count; i++) {
+        Interval* current = order[i];
+        int kept = 0;
+        for (int a = 0; a < nactive; a++) {
+            if (active[a]->end < current->start) {
+                busy[slot[active[a]->vreg]] = 0;
+            } else {
+                active[kept++] = active[a];
+            }
+        }
+        nactive = kept;
+        int s = 0;
+        while (s < *nslots && busy[s]) s++;
+        if (s == *nslots) (*nslots)++;
+        busy[s] = 1;
+        slot[current->vreg] = s;
+        active[nactive++] = current;
+    }
+    free(active);
+    free(busy);
+    free(order);
+    free(intervals);
+    return slot;
+}
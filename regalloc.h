@@ -0,0 +1,31 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include "ir.h"
+
+// Allocazione dei registri per il backend i386, sull'IR già uscito dalla forma SSA.
+// Sono allocabili EBX, ECX, ESI, EDI ed EBP (il backend omette il frame pointer quando alloca i
+// registri): EAX ed EDX restano registri di lavoro del backend, che li usa per gli operandi in
+// memoria, per cdq/idivl/imull a un operando e per setcc.
+#define REGALLOC_NREGS 5
+
+extern const char* const regalloc_names[REGALLOC_NREGS];
+
+// Scansione lineare (Poletto e Sarkar) sugli intervalli di vita nell'ordine di emissione dei blocchi.
+// candidate[v] indica i registri virtuali che hanno bisogno di una posizione (non gli immediati).
+// Restituisce per ogni registro virtuale l'indice del registro fisico, -1 se resta nel suo slot.
+int* regalloc_linear_scan(IrFunction* fn, const char* candidate);
+
+// Colorazione del grafo delle interferenze con coalescenza iterata delle copie (George e Appel).
+// Stessi argomenti e stesso risultato di regalloc_linear_scan.
+int* regalloc_graph_coloring(IrFunction* fn, const char* candidate);
+
+// Slot del frame per i registri virtuali rimasti in memoria (in_memory[v]): registri i cui
+// intervalli di vita non si sovrappongono condividono lo slot. Restituisce l'indice dello slot di
+// ogni registro (-1 per gli altri) e in *nslots il numero di slot usati.
+int* regalloc_share_slots(IrFunction* fn, const char* in_memory, int* nslots);
+
+// Vitalità all'uscita di ogni blocco: words parole per blocco, blocchi nell'ordine di emissione.
+unsigned* regalloc_live_out(IrFunction* fn, int words);
+
+#endif // REGALLOC_H
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "cfg.h"
+#include "opt.h"
+
+// Rotazione dei cicli: un while diventa un do-while protetto.
+// Il while abbassato ha il test in testa: header (phi, condizione, branch), corpo, salto all'header.
+// Ogni iterazione esegue quindi il branch dell'header e il salto incondizionato del latch.
+// Dopo la rotazione la condizione viene calcolata una volta all'ingresso (blocco di guardia) e poi
+// in fondo al corpo, con un solo branch all'indietro verso l'inizio del corpo:
+//
+//     preheader -> guardia: c0 = cond(init); branch c0, corpo, uscita
+//     corpo ... latch: c1 = cond(next); branch c1, corpo, uscita
+//
+// Le istruzioni dell'header vengono copiate nella guardia e nel latch; i valori definiti
+// nell'header diventano phi all'inizio del corpo e all'uscita, con un argomento per ciascuna copia.
+// È l'ultimo passo sui cicli: gli altri riconoscono la forma con il test nell'header.
+
+#define ROTATE_MAX_HEADER 16    // istruzioni dell'header da copiare al massimo
+
+typedef struct {
+    IrFunction* fn;
+    IrLoop* loop;
+    IrBlock* header;
+    IrBlock* preheader;
+    IrBlock* latch;
+    IrBlock* body;      // primo blocco del corpo (header->succ[0])
+    IrBlock* exit;      // header->succ[1]
+    int* header_defs;   // registri definiti nell'header, phi compresi
+    int ndefs;
+    int* map;           // registro dell'header -> valore nella copia corrente
+    int old_vregs;      // registri esistenti prima della rotazione: solo questi vanno rinominati
+} RotateState;
+
+static void* rotate_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione della rotazione dei cicli");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static int can_rotate(RotateState* state) {
+    IrLoop* loop = state->loop;
+    IrBlock* header = loop->header;
+    state->header = header;
+    if (loop->nlatches != 1 || header->npreds != 2 || header->ninsns > ROTATE_MAX_HEADER) return 0;
+    state->preheader = cfg_loop_preheader(loop);
+    state->latch = loop->latches[0];
+    IrInsn* latch_jump = ir_terminator(state->latch);
+    IrInsn* branch = ir_terminator(header);
+    if (!state->preheader || !latch_jump || latch_jump->op != IR_JUMP || !branch || branch->op != IR_BRANCH) return 0;
+
+    state->body = header->succ[0];
+    state->exit = header->succ[1];
+    if (state->body == header || !cfg_loop_contains(loop, state->body) || cfg_loop_contains(loop, state->exit)) return 0;
+    if (state->body->npreds != 1 || state->exit->npreds != 1) return 0;
+    if (state->exit->ninsns > 0 && state->exit->insns[0].op == IR_PHI) return 0;
+    // Si esce solo dall'header
+    for (int i = 0; i < loop->nblocks; i++) {
+        IrBlock* block = loop->blocks[i];
+        if (block == header) continue;
+        for (int s = 0; s < block->nsucc; s++) {
+            if (!cfg_loop_contains(loop, block->succ[s])) return 0;
+        }
+    }
+    return 1;
+}
+
+static int mapped(RotateState* state, int vreg) {
+    return state->map[vreg] ? state->map[vreg] : vreg;
+}
+
+// Copia le istruzioni non phi dell'header in coda a block e restituisce la condizione copiata.
+static int copy_header(RotateState* state, IrBlock* block) {
+    IrBlock* header = state->header;
+    for (int j = 0; j < header->ninsns; j++) {
+        IrInsn* insn = &header->insns[j];
+        if (insn->op == IR_PHI || insn->op == IR_BRANCH) continue;
+        int dst = ir_new_vreg(state->fn);
+        ir_append(block, insn->op, dst, mapped(state, insn->a), mapped(state, insn->b), insn->imm);
+        state->map[insn->dst] = dst;
+    }
+    return mapped(state, ir_terminator(header)->a);
+}
+
+static void rename_operand(RotateState* state, int* operand, int* replacement) {
+    if (*operand <= state->old_vregs && replacement[*operand]) *operand = replacement[*operand];
+}
+
+static void rewrite_uses(RotateState* state, IrBlock* block, int* replacement) {
+    for (int j = 0; j < block->ninsns; j++) {
+        int n = ir_operand_count(&block->insns[j]);
+        for (int k = 0; k < n; k++) {
+            rename_operand(state, ir_operand(&block->insns[j], k), replacement);
+        }
+    }
+}
+
+// Un phi all'inizio di block (predecessori [guardia, latch]) per ogni valore dell'header.
+static void add_phi(IrBlock* block, int index, int phi, int from_guard, int from_latch) {
+    IrInsn* insn = ir_insert(block, index, IR_PHI, phi, 0, 0, 0);
+    insn->args = (int*)rotate_alloc(2, sizeof(int));
+    insn->nargs = 2;
+    insn->args[0] = from_guard;
+    insn->args[1] = from_latch;
+}
+
+// Dopo il ciclo i valori dell'header si leggono dai phi dell'uscita: negli usi dominati
+// dall'uscita e negli argomenti dei phi che arrivano da un predecessore dominato dall'uscita.
+// Le informazioni di dominanza sono quelle di prima della rotazione, valide per i blocchi esistenti.
+static void rewrite_exit_uses(RotateState* state, int* exit_value) {
+    IrFunction* fn = state->fn;
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        int dominated = cfg_dominates(state->exit, block);
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            if (insn->op == IR_PHI) {
+                for (int p = 0; p < insn->nargs; p++) {
+                    if (cfg_dominates(state->exit, block->preds[p])) rename_operand(state, &insn->args[p], exit_value);
+                }
+            } else if (dominated) {
+                int n = ir_operand_count(insn);
+                for (int k = 0; k < n; k++) {
+                    rename_operand(state, ir_operand(insn, k), exit_value);
+                }
+            }
+        }
+    }
+}
+
+static void rotate(RotateState* state) {
+    IrFunction* fn = state->fn;
+    IrBlock* header = state->header;
+    int pre_index = header->preds[0] == state->preheader ? 0 : 1;
+    int size = fn->nvregs + 1;
+    state->old_vregs = fn->nvregs;
+
+    state->header_defs = (int*)rotate_alloc((size_t)header->ninsns, sizeof(int));
+    state->ndefs = 0;
+    for (int j = 0; j < header->ninsns; j++) {
+        if (header->insns[j].dst) state->header_defs[state->ndefs++] = header->insns[j].dst;
+    }
+    int* from_guard = (int*)rotate_alloc((size_t)state->ndefs, sizeof(int));
+    int* from_latch = (int*)rotate_alloc((size_t)state->ndefs, sizeof(int));
+    int* body_value = (int*)rotate_alloc((size_t)size, sizeof(int));
+    int* exit_value = (int*)rotate_alloc((size_t)size, sizeof(int));
+    state->map = (int*)rotate_alloc((size_t)size, sizeof(int));
+
+    // Guardia: l'header con i phi sostituiti dai valori d'ingresso
+    IrBlock* guard = ir_new_block(fn);
+    ir_place_block_after(fn, guard, header);
+    for (int j = 0; j < header->ninsns && header->insns[j].op == IR_PHI; j++) {
+        state->map[header->insns[j].dst] = header->insns[j].args[pre_index];
+    }
+    int guard_cond = copy_header(state, guard);
+    for (int d = 0; d < state->ndefs; d++) from_guard[d] = mapped(state, state->header_defs[d]);
+
+    // Nel corpo i valori dell'header diventano i phi del primo blocco. I nomi si riservano subito,
+    // perché i valori del latch (e quindi la copia dell'header nel latch) li usano.
+    for (int d = 0; d < state->ndefs; d++) body_value[state->header_defs[d]] = fn->nvregs + 1 + d;
+    fn->nvregs += state->ndefs;
+    for (int i = 0; i < state->loop->nblocks; i++) {
+        if (state->loop->blocks[i] != header) rewrite_uses(state, state->loop->blocks[i], body_value);
+    }
+
+    // Latch: l'header con i phi sostituiti dai valori di fine iterazione
+    for (int j = 0; j < size; j++) state->map[j] = 0;
+    for (int j = 0; j < header->ninsns && header->insns[j].op == IR_PHI; j++) {
+        int next = header->insns[j].args[1 - pre_index];
+        state->map[header->insns[j].dst] = body_value[next] ? body_value[next] : next;
+    }
+    ir_remove_terminator(state->latch);
+    int latch_cond = copy_header(state, state->latch);
+    for (int d = 0; d < state->ndefs; d++) from_latch[d] = mapped(state, state->header_defs[d]);
+
+    // Nuovi archi: corpo e uscita passano dall'header a [guardia, latch]
+    ir_remove_terminator(state->preheader);
+    ir_jump(state->preheader, guard);
+    state->body->npreds = 0;
+    state->exit->npreds = 0;
+    ir_branch(guard, guard_cond, state->body, state->exit);
+    ir_branch(state->latch, latch_cond, state->body, state->exit);
+
+    // Phi del corpo con i nomi riservati, phi dell'uscita per gli usi dopo il ciclo
+    for (int d = 0; d < state->ndefs; d++) {
+        add_phi(state->body, d, body_value[state->header_defs[d]], from_guard[d], from_latch[d]);
+        exit_value[state->header_defs[d]] = ir_new_vreg(fn);
+        add_phi(state->exit, d, exit_value[state->header_defs[d]], from_guard[d], from_latch[d]);
+    }
+    rewrite_exit_uses(state, exit_value);
+
+    // L'header non serve più
+    int kept = 0;
+    for (int i = 0; i < fn->nblocks; i++) {
+        if (fn->blocks[i] != header) fn->blocks[kept++] = fn->blocks[i];
+    }
+    fn->nblocks = kept;
+    for (int j = 0; j < header->ninsns; j++) free(header->insns[j].args);
+    free(header->insns);
+    free(header->preds);
+    free(header->dom_children);
+    free(header);
+
+    free(state->header_defs);
+    free(from_guard);
+    free(from_latch);
+    free(body_value);
+    free(exit_value);
+    free(state->map);
+}
+
+void opt_rotate_loops(IrFunction* fn) {
+    if (fn->nloops == 0) return;
+
+    // Come in unroll.c: gli header si scelgono prima di cambiare il grafo
+    IrBlock** headers = (IrBlock**)rotate_alloc((size_t)fn->nloops, sizeof(IrBlock*));
+    int nheaders = fn->nloops;
+    for (int l = 0; l < fn->nloops; l++) headers[l] = fn->loops[l]->header;
+
+    RotateState state;
+    state.fn = fn;
+    for (int h = 0; h < nheaders; h++) {
+        state.loop = NULL;
+        for (int l = 0; l < fn->nloops && !state.loop; l++) {
+            if (fn->loops[l]->header == headers[h]) state.loop = fn->loops[l];
+        }
+        if (!state.loop || !can_rotate(&state)) continue;
+        rotate(&state);
+        cfg_build(fn);
+    }
+    free(headers);
+}
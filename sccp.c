@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "cfg.h"
+#include "opt.h"
+
+// Propagazione sparsa condizionale delle costanti (Wegman-Zadeck).
+// Rispetto a opt_fold_constants tiene conto anche dei rami: un blocco viene considerato solo se
+// è raggiungibile lungo archi eseguibili, e un phi combina i soli argomenti che arrivano da archi
+// eseguibili. Così una variabile riassegnata solo in un ramo mai preso resta costante, e il ramo
+// stesso sparisce.
+//
+// Ogni registro ha un valore nel reticolo TOP (non ancora visto) < costante < BOTTOM (non costante)
+// e può solo scendere. Due liste di lavoro guidano l'analisi: gli archi appena diventati eseguibili
+// e i registri il cui valore è cambiato (da cui si rivisitano gli usi).
+
+enum { LATTICE_TOP, LATTICE_CONST, LATTICE_BOTTOM };
+
+typedef struct {
+    int block;  // id del blocco
+    int index;  // posizione dell'istruzione nel blocco
+} SccpUse;
+
+typedef struct {
+    IrFunction* fn;
+    IrBlock** block_by_id;
+    char* lattice;          // per registro
+    int* value;             // per registro, valido se lattice == LATTICE_CONST
+    char* block_executable; // per id di blocco
+    char** edge_executable; // per id di blocco, uno per predecessore
+    int* use_start;         // usi del registro v: uses[use_start[v] .. use_start[v + 1])
+    SccpUse* uses;
+
+    IrBlock** block_work;
+    int nblock_work;
+    int* vreg_work;
+    int nvreg_work;
+    int vreg_work_cap;
+} SccpState;
+
+static void* sccp_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione della propagazione sparsa delle costanti");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void build_uses(SccpState* state) {
+    IrFunction* fn = state->fn;
+    state->use_start = (int*)sccp_alloc((size_t)fn->nvregs + 2, sizeof(int));
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            int n = ir_operand_count(&block->insns[j]);
+            for (int k = 0; k < n; k++) {
+                state->use_start[*ir_operand(&block->insns[j], k) + 1]++;
+            }
+        }
+    }
+    for (int v = 1; v <= fn->nvregs + 1; v++) {
+        state->use_start[v] += state->use_start[v - 1];
+    }
+
+    int* fill = (int*)sccp_alloc((size_t)fn->nvregs + 1, sizeof(int));
+    state->uses = (SccpUse*)sccp_alloc((size_t)state->use_start[fn->nvregs + 1], sizeof(SccpUse));
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            int n = ir_operand_count(&block->insns[j]);
+            for (int k = 0; k < n; k++) {
+                int v = *ir_operand(&block->insns[j], k);
+                SccpUse* use = &state->uses[state->use_start[v] + fill[v]++];
+                use->block = block->id;
+                use->index = j;
+            }
+        }
+    }
+    free(fill);
+}
+
+// Abbassa il valore del registro (mai verso l'alto) e, se cambia, ne accoda gli usi.
+static void set_value(SccpState* state, int vreg, int lattice, int value) {
+    if (lattice <= state->lattice[vreg]) {
+        if (lattice != LATTICE_CONST || state->lattice[vreg] != LATTICE_CONST || state->value[vreg] == value) {
+            return;
+        }
+        lattice = LATTICE_BOTTOM;   // due costanti diverse
+    }
+    state->lattice[vreg] = (char)lattice;
+    state->value[vreg] = value;
+
+    if (state->nvreg_work == state->vreg_work_cap) {
+        state->vreg_work_cap *= 2;
+        state->vreg_work = (int*)realloc(state->vreg_work, (size_t)state->vreg_work_cap * sizeof(int));
+        if (!state->vreg_work) {
+            perror("Errore di allocazione della propagazione sparsa delle costanti");
+            exit(EXIT_FAILURE);
+        }
+    }
+    state->vreg_work[state->nvreg_work++] = vreg;
+}
+
+// Rende eseguibili gli archi da from verso to; il blocco va rivisitato se almeno uno è nuovo.
+static void mark_edge(SccpState* state, IrBlock* from, IrBlock* to) {
+    int added = 0;
+    for (int p = 0; p < to->npreds; p++) {
+        if (to->preds[p] == from && !state->edge_executable[to->id][p]) {
+            state->edge_executable[to->id][p] = 1;
+            added = 1;
+        }
+    }
+    if (added) {
+        state->block_work[state->nblock_work++] = to;
+    }
+}
+
+static void visit_insn(SccpState* state, IrBlock* block, IrInsn* insn) {
+    int a, b, result;
+    switch (insn->op) {
+        case IR_CONST:
+            set_value(state, insn->dst, LATTICE_CONST, insn->imm);
+            return;
+        case IR_COPY:
+            set_value(state, insn->dst, state->lattice[insn->a], state->value[insn->a]);
+            return;
+        case IR_PHI:
+            for (int p = 0; p < insn->nargs; p++) {
+                if (!state->edge_executable[block->id][p]) continue;
+                int arg = insn->args[p];
+                set_value(state, insn->dst, state->lattice[arg], state->value[arg]);
+            }
+            return;
+        case IR_JUMP:
+            mark_edge(state, block, block->succ[0]);
+            return;
+        case IR_BRANCH:
+            if (state->lattice[insn->a] == LATTICE_CONST) {
+                mark_edge(state, block, block->succ[state->value[insn->a] ? 0 : 1]);
+            } else if (state->lattice[insn->a] == LATTICE_BOTTOM) {
+                mark_edge(state, block, block->succ[0]);
+                mark_edge(state, block, block->succ[1]);
+            }
+            return;
+        default:
+            if (!ir_is_binary(insn->op)) return;
+            if (state->lattice[insn->a] == LATTICE_BOTTOM || state->lattice[insn->b] == LATTICE_BOTTOM) {
+                set_value(state, insn->dst, LATTICE_BOTTOM, 0);
+            } else if (state->lattice[insn->a] == LATTICE_CONST && state->lattice[insn->b] == LATTICE_CONST) {
+                a = state->value[insn->a];
+                b = state->value[insn->b];
+                if (ir_eval_binary(insn->op, a, b, &result)) {
+                    set_value(state, insn->dst, LATTICE_CONST, result);
+                } else {
+                    set_value(state, insn->dst, LATTICE_BOTTOM, 0);
+                }
+            }
+            return;
+    }
+}
+
+// Un blocco raggiunto per la prima volta si visita tutto; poi basta rivalutarne i phi,
+// gli unici che dipendono da quali archi entranti sono eseguibili.
+static void visit_block(SccpState* state, IrBlock* block) {
+    int first = !state->block_executable[block->id];
+    state->block_executable[block->id] = 1;
+    for (int j = 0; j < block->ninsns; j++) {
+        if (!first && block->insns[j].op != IR_PHI) break;
+        visit_insn(state, block, &block->insns[j]);
+    }
+}
+
+static void analyze(SccpState* state) {
+    visit_block(state, state->fn->blocks[0]);
+    while (state->nblock_work > 0 || state->nvreg_work > 0) {
+        if (state->nblock_work > 0) {
+            visit_block(state, state->block_work[--state->nblock_work]);
+            continue;
+        }
+        int v = state->vreg_work[--state->nvreg_work];
+        for (int u = state->use_start[v]; u < state->use_start[v + 1]; u++) {
+            IrBlock* block = state->block_by_id[state->uses[u].block];
+            if (state->block_executable[block->id]) {
+                visit_insn(state, block, &block->insns[state->uses[u].index]);
+            }
+        }
+    }
+}
+
+// Applica il risultato: i registri costanti diventano IR_CONST e i branch con condizione nota
+// diventano salti. I blocchi mai eseguiti restano così irraggiungibili e vengono eliminati.
+static void rewrite(SccpState* state) {
+    IrFunction* fn = state->fn;
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        if (!state->block_executable[block->id]) continue;
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            if (insn->op == IR_BRANCH && state->lattice[insn->a] == LATTICE_CONST) {
+                ir_branch_to_jump(block, state->value[insn->a] ? 0 : 1);
+                continue;
+            }
+            if (!insn->dst || insn->op == IR_CONST || state->lattice[insn->dst] != LATTICE_CONST) continue;
+
+            IrOp op = insn->op;
+            free(insn->args);
+            insn->args = NULL;
+            insn->nargs = 0;
+            insn->op = IR_CONST;
+            insn->a = 0;
+            insn->b = 0;
+            insn->imm = state->value[insn->dst];
+            if (op == IR_PHI) {
+                // Come in opt_fold_constants: al suo posto scala il phi successivo
+                ir_move_after_phis(block, j);
+                if (block->insns[j].op == IR_PHI) j--;
+            }
+        }
+    }
+}
+
+void opt_sccp(IrFunction* fn) {
+    SccpState state;
+    state.fn = fn;
+    state.block_by_id = (IrBlock**)sccp_alloc((size_t)fn->next_block_id, sizeof(IrBlock*));
+    state.block_executable = (char*)sccp_alloc((size_t)fn->next_block_id, 1);
+    state.edge_executable = (char**)sccp_alloc((size_t)fn->next_block_id, sizeof(char*));
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        state.block_by_id[block->id] = block;
+        state.edge_executable[block->id] = (char*)sccp_alloc((size_t)block->npreds, 1);
+    }
+    state.lattice = (char*)sccp_alloc((size_t)fn->nvregs + 1, 1);
+    state.value = (int*)sccp_alloc((size_t)fn->nvregs + 1, sizeof(int));
+    // Ogni blocco entra in lista al più una volta per arco entrante
+    int nedges = 1;
+    for (int i = 0; i < fn->nblocks; i++) nedges += fn->blocks[i]->npreds;
+    state.block_work = (IrBlock**)sccp_alloc((size_t)nedges, sizeof(IrBlock*));
+    state.nblock_work = 0;
+    state.vreg_work_cap = 64;
+    state.vreg_work = (int*)sccp_alloc((size_t)state.vreg_work_cap, sizeof(int));
+    state.nvreg_work = 0;
+    build_uses(&state);
+
+    analyze(&state);
+    rewrite(&state);
+
+    for (int i = 0; i < fn->next_block_id; i++) free(state.edge_executable[i]);
+    free(state.edge_executable);
+    free(state.block_executable);
+    free(state.block_by_id);
+    free(state.lattice);
+    free(state.value);
+    free(state.block_work);
+    free(state.vreg_work);
+    free(state.use_start);
+    free(state.uses);
+
+    // I blocchi mai eseguiti ora non hanno più archi eseguibili in ingresso
+    cfg_build(fn);
+    ir_remove_unreachable_blocks(fn);
+    cfg_build(fn);
+    // I phi rimasti con un solo argomento diventano semplici alias
+    opt_propagate_copies(fn);
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ast.h"
+#include "codegen.h"
+#include "sema.h"
+
+// Stato dell'analisi per la funzione corrente.
+static const char* current_function = NULL;
+static int next_slot = 0;
+static int max_slot = 0;
+static int error_count = 0;
+
+static void resolve_expression(Node* node);
+static void resolve_statements(List* list);
+
+// Registra una dichiarazione nella tabella dei simboli assegnandole il prossimo slot libero.
+static void declare_variable(Node* decl) {
+    char* name = decl->declaration_stmt.identifier;
+    if (is_declared_in_current_scope(name, decl->name_hash)) {
+        fprintf(stderr, "Errore: variabile '%s' già dichiarata nella funzione '%s'.\n",
+                name, current_function);
+        error_count++;
+        return;
+    }
+    decl->slot = next_slot++;
+    if (next_slot > max_slot) {
+        max_slot = next_slot;
+    }
+    add_symbol(name, decl->name_hash, decl->slot);
+}
+
+// Cerca lo slot di un nome usato in un'espressione, segnalando l'errore se manca.
+static int resolve_use(char* name, unsigned int hash) {
+    int slot = get_symbol_slot(name, hash);
+    if (slot < 0) {
+        fprintf(stderr, "Errore: variabile '%s' non dichiarata nella funzione '%s'.\n",
+                name, current_function);
+        error_count++;
+    }
+    return slot;
+}
+
+static void resolve_expression(Node* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            node->slot = resolve_use(node->identifier_name, node->name_hash);
+            break;
+        case NODE_ASSIGN_OP:
+            // Prima l'espressione, poi la destinazione: l'ordine non cambia il risultato
+            // ma i messaggi di errore seguono l'ordine di valutazione.
+            resolve_expression(node->assign_op.expression);
+            node->slot = resolve_use(node->assign_op.identifier, node->name_hash);
+            break;
+        case NODE_PLUS:
+        case NODE_MINUS:
+        case NODE_MULT:
+        case NODE_DIVIDE:
+        case NODE_EQUAL_OP:
+        case NODE_NOT_EQUAL_OP:
+        case NODE_LESS_THAN_OP:
+        case NODE_GREATER_THAN_OP:
+            resolve_expression(node->binary_op.left);
+            resolve_expression(node->binary_op.right);
+            break;
+        default:
+            break;
+    }
+}
+
+// Risolve il corpo di un if/while come uno scope a sé. Alla chiusura gli slot delle sue variabili
+// tornano liberi: blocchi fratelli, le cui variabili non sono mai vive insieme, riusano gli stessi slot.
+static void resolve_block(List* list) {
+    int saved_next_slot = next_slot;
+    push_scope();
+    resolve_statements(list);
+    pop_scope();
+    next_slot = saved_next_slot;
+}
+
+static void resolve_statement(Node* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NODE_DECLARATION:
+            declare_variable(node);
+            break;
+        case NODE_EXPR_STMT:
+            resolve_expression(node->expr_stmt.expression);
+            break;
+        case NODE_RETURN_STMT:
+            resolve_expression(node->return_stmt.expression);
+            break;
+        case NODE_IF_STMT:
+        case NODE_IF_ELSE_STMT:
+            resolve_expression(node->if_stmt.condition);
+            resolve_block(node->if_stmt.if_body);
+            resolve_block(node->if_stmt.else_body);
+            break;
+        case NODE_WHILE_STMT:
+            resolve_expression(node->while_stmt.condition);
+            resolve_block(node->while_stmt.while_body);
+            break;
+        default:
+            break;
+    }
+}
+
+static void resolve_statements(List* list) {
+    for (List* current = list; current != NULL; current = current->next) {
+        resolve_statement(current->node);
+    }
+}
+
+static void resolve_function(Node* function) {
+    current_function = function->function_def.name;
+    next_slot = 0;
+    max_slot = 0;
+
+    for (List* decl = function->function_def.declarations; decl != NULL; decl = decl->next) {
+        declare_variable(decl->node);
+    }
+    resolve_statements(function->function_def.statements);
+
+    function->function_def.frame_slots = max_slot;
+    free_symbol_table();
+}
+
+// Controlla che i nomi delle funzioni siano unici, riusando la tabella dei simboli
+// (che poi viene svuotata: ogni funzione ha la sua tabella e il suo frame).
+static void check_function_names(List* functions) {
+    int index = 0;
+    for (List* current = functions; current != NULL; current = current->next, index++) {
+        Node* function = current->node;
+        if (get_symbol_slot(function->function_def.name, function->name_hash) >= 0) {
+            fprintf(stderr, "Errore: funzione '%s' definita più volte.\n", function->function_def.name);
+            error_count++;
+            continue;
+        }
+        add_symbol(function->function_def.name, function->name_hash, index);
+    }
+    free_symbol_table();
+}
+
+int resolve_names(Node* root) {
+    error_count = 0;
+    if (!root) return 0;
+
+    if (root->type == NODE_PROGRAM) {
+        check_function_names(root->program_node.functions);
+        for (List* current = root->program_node.functions; current != NULL; current = current->next) {
+            resolve_function(current->node);
+        }
+    } else if (root->type == NODE_FUNCTION) {
+        resolve_function(root);
+    }
+    return error_count;
+}
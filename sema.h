@@ -0,0 +1,13 @@
+#ifndef SEMA_H
+#define SEMA_H
+
+#include "ast.h"
+
+// Analisi semantica: risolve ogni identificatore (NODE_IDENTIFIER, NODE_ASSIGN_OP)
+// nello slot del frame della variabile, salvandolo in node->slot, e calcola
+// function_def.frame_slots. Segnala variabili non dichiarate o dichiarate due volte.
+// Le dichiarazioni nei blocchi di if/while sono visibili solo nel blocco; blocchi fratelli riusano gli stessi slot.
+// Restituisce il numero di errori trovati (0 se il programma è corretto).
+int resolve_names(Node* root);
+
+#endif // SEMA_H
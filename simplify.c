@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ir.h"
+#include "opt.h"
+
+// Semplificazione algebrica e forma canonica delle operazioni.
+// Le costanti passano a destra degli operatori commutativi (c + x diventa x + c, c < x diventa
+// x > c), così le regole successive guardano un solo lato. Le identità si riscrivono come copie
+// o costanti:
+//
+//     x + 0, x - 0, x * 1, x / 1  ->  x          x * 0  ->  0          x - x  ->  0
+//     x == x  ->  1                               x != x, x < x, x > x  ->  0
+//     0 - (0 - x)  ->  x          x + (0 - y)  ->  x - y          x - (0 - y)  ->  x + y
+//
+// Le catene di costanti si riassociano: (x + c1) - c2 diventa x + (c1 - c2) e (x * c1) * c2
+// diventa x * (c1 * c2), con l'aritmetica modulo 2^32 di ir_eval_binary. x / x non si tocca:
+// con x == 0 la divisione deve fermare il programma.
+// Le istruzioni interne rimaste senza usi le toglie opt_dead_code; le copie opt_propagate_copies.
+
+typedef struct {
+    IrFunction* fn;
+    // Istruzione che definisce ogni registro, copiata per non dipendere dalle posizioni nei blocchi
+    IrOp* op;
+    int* a;
+    int* b;
+    int* imm;
+    char* defined;
+    int capacity;
+} SimplifyState;
+
+static void note_def(SimplifyState* state, IrInsn* insn) {
+    if (insn->dst >= state->capacity) {
+        int capacity = state->fn->nvregs + 1;
+        state->op = (IrOp*)realloc(state->op, (size_t)capacity * sizeof(IrOp));
+        state->a = (int*)realloc(state->a, (size_t)capacity * sizeof(int));
+        state->b = (int*)realloc(state->b, (size_t)capacity * sizeof(int));
+        state->imm = (int*)realloc(state->imm, (size_t)capacity * sizeof(int));
+        state->defined = (char*)realloc(state->defined, (size_t)capacity);
+        if (!state->op || !state->a || !state->b || !state->imm || !state->defined) {
+            perror("Errore di allocazione della semplificazione algebrica");
+            exit(EXIT_FAILURE);
+        }
+        for (int v = state->capacity; v < capacity; v++) state->defined[v] = 0;
+        state->capacity = capacity;
+    }
+    state->op[insn->dst] = insn->op;
+    state->a[insn->dst] = insn->a;
+    state->b[insn->dst] = insn->b;
+    state->imm[insn->dst] = insn->imm;
+    state->defined[insn->dst] = 1;
+}
+
+static int is_constant(SimplifyState* state, int vreg, int* value) {
+    if (!state->defined[vreg] || state->op[vreg] != IR_CONST) return 0;
+    *value = state->imm[vreg];
+    return 1;
+}
+
+// x = 0 - y: restituisce y
+static int negated(SimplifyState* state, int vreg) {
+    int zero;
+    if (!state->defined[vreg] || state->op[vreg] != IR_SUB) return 0;
+    if (!is_constant(state, state->a[vreg], &zero) || zero != 0) return 0;
+    return state->b[vreg];
+}
+
+static void rewrite(SimplifyState* state, IrInsn* insn, IrOp op, int a, int b, int imm) {
+    insn->op = op;
+    insn->a = a;
+    insn->b = b;
+    insn->imm = imm;
+    note_def(state, insn);
+}
+
+// Inserisce una costante prima dell'istruzione index e ne restituisce il registro:
+// l'istruzione passa alla posizione index + 1.
+static int insert_constant(SimplifyState* state, IrBlock* block, int index, int value) {
+    int dst = ir_new_vreg(state->fn);
+    note_def(state, ir_insert(block, index, IR_CONST, dst, 0, 0, value));
+    return dst;
+}
+
+// Restituisce 1 se ha cambiato l'istruzione (che dopo un inserimento si trova in *index).
+static int simplify_insn(SimplifyState* state, IrBlock* block, int* index) {
+    IrInsn* insn = &block->insns[*index];
+    if (!ir_is_binary(insn->op)) return 0;
+    IrOp op = insn->op;
+    int a = insn->a, b = insn->b;
+    int ca = 0, cb = 0, inner;
+    int a_constant = is_constant(state, a, &ca);
+    int b_constant = is_constant(state, b, &cb);
+
+    // Forma canonica: costante a destra
+    if (a_constant && !b_constant && op != IR_SUB && op != IR_DIV) {
+        IrOp swapped = op == IR_LT ? IR_GT : op == IR_GT ? IR_LT : op;
+        rewrite(state, insn, swapped, b, a, 0);
+        return 1;
+    }
+
+    if (a == b) {
+        switch (op) {
+            case IR_SUB: case IR_NE: case IR_LT: case IR_GT:
+                rewrite(state, insn, IR_CONST, 0, 0, 0);
+                return 1;
+            case IR_EQ:
+                rewrite(state, insn, IR_CONST, 0, 0, 1);
+                return 1;
+            default:
+                break;
+        }
+    }
+
+    if (b_constant && !a_constant) {
+        if ((cb == 0 && (op == IR_ADD || op == IR_SUB)) || (cb == 1 && (op == IR_MUL || op == IR_DIV))) {
+            rewrite(state, insn, IR_COPY, a, 0, 0);
+            return 1;
+        }
+        if (cb == 0 && op == IR_MUL) {
+            rewrite(state, insn, IR_CONST, 0, 0, 0);
+            return 1;
+        }
+        // Riassociazione: (x +- c1) +- c2 e (x * c1) * c2
+        int c1, c0;
+        if ((op == IR_ADD || op == IR_SUB) && state->defined[a] &&
+            (state->op[a] == IR_ADD || state->op[a] == IR_SUB) && is_constant(state, state->b[a], &c1) &&
+            !is_constant(state, state->a[a], &c0)) {
+            int total;
+            ir_eval_binary(state->op[a], 0, c1, &total);
+            ir_eval_binary(op, total, cb, &total);
+            int x = state->a[a];
+            int k = insert_constant(state, block, (*index)++, total);
+            rewrite(state, &block->insns[*index], IR_ADD, x, k, 0);
+            return 1;
+        }
+        if (op == IR_MUL && state->defined[a] && state->op[a] == IR_MUL && is_constant(state, state->b[a], &c1) &&
+            !is_constant(state, state->a[a], &c0)) {
+            int total;
+            ir_eval_binary(IR_MUL, c1, cb, &total);
+            int x = state->a[a];
+            int k = insert_constant(state, block, (*index)++, total);
+            rewrite(state, &block->insns[*index], IR_MUL, x, k, 0);
+            return 1;
+        }
+    }
+
+    // Negazioni: 0 - (0 - x), x + (0 - y), (0 - y) + x, x - (0 - y)
+    if (op == IR_SUB && a_constant && ca == 0 && (inner = negated(state, b))) {
+        rewrite(state, insn, IR_COPY, inner, 0, 0);
+        return 1;
+    }
+    if (op == IR_ADD && (inner = negated(state, b))) {
+        rewrite(state, insn, IR_SUB, a, inner, 0);
+        return 1;
+    }
+    if (op == IR_ADD && (inner = negated(state, a))) {
+        rewrite(state, insn, IR_SUB, b, inner, 0);
+        return 1;
+    }
+    if (op == IR_SUB && !(a_constant && ca == 0) && (inner = negated(state, b))) {
+        rewrite(state, insn, IR_ADD, a, inner, 0);
+        return 1;
+    }
+    return 0;
+}
+
+void opt_simplify(IrFunction* fn) {
+    SimplifyState state;
+    state.fn = fn;
+    state.op = NULL;
+    state.a = NULL;
+    state.b = NULL;
+    state.imm = NULL;
+    state.defined = NULL;
+    state.capacity = 0;
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            if (block->insns[j].dst) note_def(&state, &block->insns[j]);
+        }
+    }
+    if (state.capacity == 0) return;
+
+    // In ordine inverso di postordine le definizioni (phi a parte) precedono gli usi:
+    // gli operandi sono già nella forma semplificata quando si guarda un'istruzione.
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < fn->nrpo; i++) {
+            IrBlock* block = fn->rpo[i];
+            for (int j = 0; j < block->ninsns; j++) {
+                while (simplify_insn(&state, block, &j)) changed = 1;
+            }
+        }
+    }
+
+    free(state.op);
+    free(state.a);
+    free(state.b);
+    free(state.imm);
+    free(state.defined);
+    opt_propagate_copies(fn);
+}
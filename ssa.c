@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+#include "ssa.h"
+
+// Stato della costruzione per la funzione corrente. Le tabelle per blocco sono indicizzate con block->id.
+typedef struct {
+    int var;
+    int phi;
+} IncompletePhi;
+
+typedef struct {
+    int* defs;                  // definizione corrente di ogni variabile nel blocco, 0 se assente
+    int sealed;
+    IncompletePhi* incomplete;  // phi creati prima che il blocco fosse sigillato
+    int nincomplete;
+    int incomplete_cap;
+} BlockState;
+
+static IrFunction* fn = NULL;
+static int nvars = 0;
+static BlockState* states = NULL;
+static int nstates = 0;
+static int* alias = NULL;       // alias[v] != 0: v era un phi banale, sostituito da alias[v]
+static int alias_cap = 0;
+
+static void* checked_realloc(void* ptr, size_t size) {
+    ptr = realloc(ptr, size ? size : 1);
+    if (!ptr) {
+        perror("Errore di allocazione della forma SSA");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static BlockState* state_of(IrBlock* block) {
+    if (block->id >= nstates) {
+        int new_count = nstates ? nstates : 16;
+        while (new_count <= block->id) new_count *= 2;
+        states = (BlockState*)checked_realloc(states, sizeof(BlockState) * (size_t)new_count);
+        memset(&states[nstates], 0, sizeof(BlockState) * (size_t)(new_count - nstates));
+        nstates = new_count;
+    }
+    BlockState* state = &states[block->id];
+    if (!state->defs) {
+        state->defs = (int*)calloc((size_t)(nvars ? nvars : 1), sizeof(int));
+        if (!state->defs) {
+            perror("Errore di allocazione della forma SSA");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return state;
+}
+
+// Segue la catena degli alias fino al valore che sostituisce definitivamente un phi banale.
+static int resolve(int value) {
+    while (value < alias_cap && alias[value]) {
+        value = alias[value];
+    }
+    return value;
+}
+
+static void set_alias(int from, int to) {
+    if (from >= alias_cap) {
+        int new_cap = alias_cap ? alias_cap : 64;
+        while (new_cap <= from) new_cap *= 2;
+        alias = (int*)checked_realloc(alias, sizeof(int) * (size_t)new_cap);
+        memset(&alias[alias_cap], 0, sizeof(int) * (size_t)(new_cap - alias_cap));
+        alias_cap = new_cap;
+    }
+    alias[from] = to;
+}
+
+static int find_phi(IrBlock* block, int phi) {
+    for (int i = 0; i < block->ninsns && block->insns[i].op == IR_PHI; i++) {
+        if (block->insns[i].dst == phi) return i;
+    }
+    return -1;
+}
+
+static int new_phi(IrBlock* block) {
+    int phi = ir_new_vreg(fn);
+    int position = 0;
+    while (position < block->ninsns && block->insns[position].op == IR_PHI) position++;
+    ir_insert(block, position, IR_PHI, phi, 0, 0, 0);
+    return phi;
+}
+
+// Valore di una variabile mai assegnata: come la vecchia memoria dello stack, ma deterministico (0).
+static int undefined_value(IrBlock* block) {
+    int position = 0;
+    while (position < block->ninsns && block->insns[position].op == IR_PHI) position++;
+    int value = ir_new_vreg(fn);
+    ir_insert(block, position, IR_CONST, value, 0, 0, 0);
+    return value;
+}
+
+// Un phi è banale se tutti i suoi argomenti, esclusi i riferimenti a se stesso, sono lo stesso valore.
+// In quel caso viene eliminato e gli usi vengono rediretti (tramite alias) su quel valore.
+// Restituisce 1 se il phi è stato eliminato o trasformato.
+static int try_remove_trivial_phi(IrBlock* block, int index) {
+    IrInsn* phi = &block->insns[index];
+    int same = 0;
+    for (int i = 0; i < phi->nargs; i++) {
+        int arg = resolve(phi->args[i]);
+        if (arg == same || arg == phi->dst) continue;
+        if (same != 0) return 0;
+        same = arg;
+    }
+    if (same == 0) {
+        // Il phi si riferisce solo a se stesso: la variabile non è mai stata assegnata.
+        free(phi->args);
+        phi->args = NULL;
+        phi->nargs = 0;
+        phi->op = IR_CONST;
+        phi->imm = 0;
+        // Le costanti non possono stare tra i phi: sposta in fondo alla sequenza di phi.
+        ir_move_after_phis(block, index);
+        return 1;
+    }
+    set_alias(phi->dst, same);
+    ir_remove(block, index);
+    return 1;
+}
+
+static void add_phi_operands(int var, IrBlock* block, int phi) {
+    int* args = (int*)checked_realloc(NULL, sizeof(int) * (size_t)block->npreds);
+    for (int p = 0; p < block->npreds; p++) {
+        args[p] = ssa_read_variable(var, block->preds[p]);
+    }
+    // La lettura ricorsiva può aver inserito altri phi nel blocco: l'indice va ricercato.
+    int index = find_phi(block, phi);
+    block->insns[index].args = args;
+    block->insns[index].nargs = block->npreds;
+    try_remove_trivial_phi(block, index);
+}
+
+void ssa_begin(IrFunction* function, int variable_count) {
+    fn = function;
+    nvars = variable_count;
+}
+
+void ssa_write_variable(int var, IrBlock* block, int value) {
+    state_of(block)->defs[var] = value;
+}
+
+static int read_variable_recursive(int var, IrBlock* block) {
+    BlockState* state = state_of(block);
+    int value;
+    if (!state->sealed) {
+        // Predecessori ancora incompleti: phi provvisorio, riempito alla sigillatura.
+        value = new_phi(block);
+        state = state_of(block);
+        if (state->nincomplete == state->incomplete_cap) {
+            state->incomplete_cap = state->incomplete_cap ? state->incomplete_cap * 2 : 4;
+            state->incomplete = (IncompletePhi*)checked_realloc(state->incomplete,
+                sizeof(IncompletePhi) * (size_t)state->incomplete_cap);
+        }
+        state->incomplete[state->nincomplete].var = var;
+        state->incomplete[state->nincomplete].phi = value;
+        state->nincomplete++;
+    } else if (block->npreds == 0) {
+        value = undefined_value(block);
+    } else if (block->npreds == 1) {
+        value = ssa_read_variable(var, block->preds[0]);
+    } else {
+        // Il phi viene registrato prima di leggere i predecessori per interrompere i cicli.
+        value = new_phi(block);
+        ssa_write_variable(var, block, value);
+        add_phi_operands(var, block, value);
+        value = resolve(value);
+    }
+    ssa_write_variable(var, block, value);
+    return value;
+}
+
+int ssa_read_variable(int var, IrBlock* block) {
+    int value = state_of(block)->defs[var];
+    if (value) {
+        return resolve(value);
+    }
+    return read_variable_recursive(var, block);
+}
+
+void ssa_seal_block(IrBlock* block) {
+    BlockState* state = state_of(block);
+    for (int i = 0; i < state->nincomplete; i++) {
+        add_phi_operands(state->incomplete[i].var, block, state->incomplete[i].phi);
+        state = state_of(block);
+    }
+    state->nincomplete = 0;
+    state->sealed = 1;
+}
+
+static void rewrite_operands(void) {
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            insn->a = resolve(insn->a);
+            insn->b = resolve(insn->b);
+            for (int k = 0; k < insn->nargs; k++) {
+                insn->args[k] = resolve(insn->args[k]);
+            }
+        }
+    }
+}
+
+void ssa_finish(void) {
+    // Eliminare un phi può rendere banali i phi che lo usavano: si ripete fino al punto fisso.
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < fn->nblocks; i++) {
+            IrBlock* block = fn->blocks[i];
+            for (int j = 0; j < block->ninsns && block->insns[j].op == IR_PHI; ) {
+                if (try_remove_trivial_phi(block, j)) {
+                    changed = 1;
+                } else {
+                    j++;
+                }
+            }
+        }
+    }
+    rewrite_operands();
+
+    for (int i = 0; i < nstates; i++) {
+        free(states[i].defs);
+        free(states[i].incomplete);
+    }
+    free(states);
+    free(alias);
+    states = NULL;
+    nstates = 0;
+    alias = NULL;
+    alias_cap = 0;
+    fn = NULL;
+}
+
+// Sequenzializza la copia parallela dsts[i] = srcs[i] inserendo le copie prima del terminatore.
+// Una copia si può emettere quando la sua destinazione non è più letta da altre copie in sospeso;
+// se restano solo cicli, il valore di una destinazione viene salvato in un temporaneo.
+static void sequentialize(IrFunction* function, IrBlock* block, int* dsts, int* srcs, int count) {
+    int position = block->ninsns - 1; // prima del salto finale
+    int pending = count;
+    char* done = (char*)calloc((size_t)(count ? count : 1), 1);
+    if (!done) {
+        perror("Errore di allocazione della forma SSA");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; i++) {
+        if (dsts[i] == srcs[i]) {
+            done[i] = 1;
+            pending--;
+        }
+    }
+
+    while (pending > 0) {
+        int progress = 0;
+        for (int i = 0; i < count; i++) {
+            if (done[i]) continue;
+            int blocked = 0;
+            for (int j = 0; j < count; j++) {
+                if (!done[j] && j != i && srcs[j] == dsts[i]) {
+                    blocked = 1;
+                    break;
+                }
+            }
+            if (blocked) continue;
+            ir_insert(block, position++, IR_COPY, dsts[i], srcs[i], 0, 0);
+            done[i] = 1;
+            pending--;
+            progress = 1;
+        }
+        if (!progress) {
+            // Solo cicli: salva una destinazione e fai leggere il temporaneo a chi la usava.
+            int i = 0;
+            while (done[i]) i++;
+            int temp = ir_new_vreg(function);
+            ir_insert(block, position++, IR_COPY, temp, dsts[i], 0, 0);
+            for (int j = 0; j < count; j++) {
+                if (!done[j] && srcs[j] == dsts[i]) {
+                    srcs[j] = temp;
+                }
+            }
+        }
+    }
+    free(done);
+}
+
+void ssa_destruct(IrFunction* function) {
+    // Gli archi critici (da un blocco con più successori verso un blocco con phi) vanno spezzati:
+    // altrimenti le copie in coda al predecessore verrebbero eseguite anche sull'altro ramo.
+    for (int i = 0; i < function->nblocks; i++) {
+        IrBlock* block = function->blocks[i];
+        if (block->ninsns == 0 || block->insns[0].op != IR_PHI) continue;
+        for (int p = 0; p < block->npreds; p++) {
+            IrBlock* pred = block->preds[p];
+            if (pred->nsucc > 1) {
+                int succ_index = pred->succ[0] == block ? 0 : 1;
+                ir_split_edge(function, pred, succ_index);
+            }
+        }
+    }
+
+    for (int i = 0; i < function->nblocks; i++) {
+        IrBlock* block = function->blocks[i];
+        int nphis = 0;
+        while (nphis < block->ninsns && block->insns[nphis].op == IR_PHI) nphis++;
+        if (nphis == 0) continue;
+
+        int* dsts = (int*)checked_realloc(NULL, sizeof(int) * (size_t)nphis);
+        int* srcs = (int*)checked_realloc(NULL, sizeof(int) * (size_t)nphis);
+        for (int p = 0; p < block->npreds; p++) {
+            for (int k = 0; k < nphis; k++) {
+                dsts[k] = block->insns[k].dst;
+                srcs[k] = block->insns[k].args[p];
+            }
+            sequentialize(function, block->preds[p], dsts, srcs, nphis);
+        }
+        free(dsts);
+        free(srcs);
+        while (nphis-- > 0) {
+            ir_remove(block, 0);
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "ir.h"
+
+// Costruzione della forma SSA durante l'abbassamento dell'AST, con l'algoritmo "al volo" di
+// Braun et al. ("Simple and Efficient Construction of Static Single Assignment Form").
+// Le variabili sono identificate dallo slot assegnato da sema.c. Un blocco va sigillato con
+// ssa_seal_block quando tutti i suoi predecessori sono noti.
+void ssa_begin(IrFunction* fn, int nvars);
+void ssa_write_variable(int var, IrBlock* block, int value);
+int ssa_read_variable(int var, IrBlock* block);
+void ssa_seal_block(IrBlock* block);
+// Rimuove i phi banali rimasti e riscrive gli operandi che li usavano. Chiude la costruzione.
+void ssa_finish(void);
+
+// Distruzione della forma SSA: spezza gli archi critici e sostituisce i phi con copie in coda
+// ai predecessori, sequenzializzando ogni copia parallela (i cicli si rompono con un registro temporaneo).
+void ssa_destruct(IrFunction* fn);
+
+#endif // SSA_H
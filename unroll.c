@@ -0,0 +1,385 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "ir.h"
+#include "cfg.h"
+#include "opt.h"
+
+// Srotolamento dei cicli più interni.
+// Si considerano i cicli prodotti da un while: si esce solo dall'header, con il test "i < n" su una
+// variabile di induzione i che cresce di un passo costante, e n invariante. Il ciclo originale resta
+// al suo posto e fa da ciclo di resto; davanti gli si mettono copie del corpo senza test:
+//
+// - numero di iterazioni noto (init, passo e n costanti) e corpo abbastanza piccolo: tutte le
+//   iterazioni vengono copiate in fila. Il ciclo originale parte allora con i già a n e
+//   opt_sccp ne dimostra il test falso, eliminandolo.
+// - altrimenti: un nuovo ciclo esegue factor copie del corpo per ogni test "i < n - (factor-1)*passo",
+//   cioè solo finché tutte le factor iterazioni sono garantite; le ultime restano al ciclo originale.
+//   Se n - (factor-1)*passo trabocca il limite diventa INT_MIN e tutto il lavoro va al ciclo di resto.
+//
+// Ogni copia ripete anche le istruzioni dell'header (il test compreso, che resta morto), così
+// i valori calcolati nell'header sono disponibili al corpo copiato.
+
+#define UNROLL_BUDGET 128   // istruzioni copiate al massimo per ciclo
+
+typedef struct {
+    IrFunction* fn;
+    IrLoop* loop;
+    IrBlock* preheader;
+    IrBlock* latch;
+    IrBlock* body_entry;
+    int pre_index;      // posizione del preheader tra i predecessori dell'header
+    IrBlock** body;     // blocchi del ciclo tranne l'header, in ordine RPO
+    int nbody;
+    IrBlock** clones;   // copia di body[i] nell'iterazione corrente
+    int* map;           // registro originale -> registro della copia corrente (0 = invariato)
+    int map_size;
+
+    // Test di uscita "iv < bound" con iv = phi [init, iv + step]
+    int iv;
+    int init;
+    int step;
+    int bound;
+} UnrollState;
+
+static void* unroll_alloc(size_t count, size_t size) {
+    void* p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("Errore di allocazione dello srotolamento dei cicli");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static IrInsn* find_def_in(IrBlock* block, int vreg) {
+    for (int j = 0; j < block->ninsns; j++) {
+        if (block->insns[j].dst == vreg) return &block->insns[j];
+    }
+    return NULL;
+}
+
+static IrInsn* find_def(UnrollState* state, int vreg) {
+    IrInsn* def = NULL;
+    for (int i = 0; i < state->fn->nblocks && !def; i++) {
+        def = find_def_in(state->fn->blocks[i], vreg);
+    }
+    return def;
+}
+
+static int constant_value(UnrollState* state, int vreg, int* value) {
+    IrInsn* def = find_def(state, vreg);
+    if (!def || def->op != IR_CONST) return 0;
+    *value = def->imm;
+    return 1;
+}
+
+static int defined_in_loop(UnrollState* state, int vreg) {
+    for (int i = 0; i < state->loop->nblocks; i++) {
+        if (find_def_in(state->loop->blocks[i], vreg)) return 1;
+    }
+    return 0;
+}
+
+static int compare_rpo(const void* a, const void* b) {
+    return (*(IrBlock* const*)a)->rpo_index - (*(IrBlock* const*)b)->rpo_index;
+}
+
+// Forma del ciclo: un solo ingresso, un solo latch, uscita solo dall'header, test su una
+// variabile di induzione con passo costante positivo. Restituisce le istruzioni copiate per iterazione.
+static int analyze_loop(UnrollState* state) {
+    IrLoop* loop = state->loop;
+    IrBlock* header = loop->header;
+    if (loop->nchildren != 0 || loop->nlatches != 1 || header->npreds != 2) return 0;
+    state->preheader = cfg_loop_preheader(loop);
+    state->latch = loop->latches[0];
+    IrInsn* latch_jump = ir_terminator(state->latch);
+    if (!state->preheader || !latch_jump || latch_jump->op != IR_JUMP) return 0;
+    state->pre_index = header->preds[0] == state->preheader ? 0 : 1;
+
+    IrInsn* branch = ir_terminator(header);
+    if (!branch || branch->op != IR_BRANCH) return 0;
+    state->body_entry = header->succ[0];
+    if (state->body_entry == header || !cfg_loop_contains(loop, state->body_entry) ||
+        cfg_loop_contains(loop, header->succ[1])) return 0;
+
+    int size = 0;
+    state->nbody = 0;
+    for (int i = 0; i < loop->nblocks; i++) {
+        IrBlock* block = loop->blocks[i];
+        size += block->ninsns;
+        if (block == header) continue;
+        for (int s = 0; s < block->nsucc; s++) {
+            if (!cfg_loop_contains(loop, block->succ[s])) return 0;
+        }
+        state->body[state->nbody++] = block;
+    }
+    qsort(state->body, (size_t)state->nbody, sizeof(IrBlock*), compare_rpo);
+
+    // Test di uscita
+    IrInsn* test = find_def_in(header, branch->a);
+    if (!test) return 0;
+    if (test->op == IR_LT) {
+        state->iv = test->a;
+        state->bound = test->b;
+    } else if (test->op == IR_GT) {
+        state->iv = test->b;
+        state->bound = test->a;
+    } else {
+        return 0;
+    }
+    if (defined_in_loop(state, state->bound)) return 0;
+    IrInsn* phi = find_def_in(header, state->iv);
+    if (!phi || phi->op != IR_PHI) return 0;
+    state->init = phi->args[state->pre_index];
+    IrInsn* update = find_def(state, phi->args[1 - state->pre_index]);
+    if (!update || update->op != IR_ADD) return 0;
+    int step_vreg = update->a == state->iv ? update->b : update->b == state->iv ? update->a : 0;
+    if (!step_vreg || !constant_value(state, step_vreg, &state->step) || state->step <= 0) return 0;
+    return size;
+}
+
+static int mapped(UnrollState* state, int vreg) {
+    if (vreg < state->map_size && state->map[vreg]) return state->map[vreg];
+    return vreg;
+}
+
+static int clone_index(UnrollState* state, IrBlock* block) {
+    for (int i = 0; i < state->nbody; i++) {
+        if (state->body[i] == block) return i;
+    }
+    return -1;
+}
+
+// Copia un'iterazione: le istruzioni dell'header (senza phi) in coda a entry, poi il corpo.
+// All'ingresso map dà il valore dei phi dell'header per questa iterazione; i registri definiti nel
+// ciclo vengono rinominati. Restituisce la copia del latch, ancora senza terminatore.
+static IrBlock* clone_iteration(UnrollState* state, IrBlock* entry, IrBlock** after) {
+    IrFunction* fn = state->fn;
+    IrBlock* header = state->loop->header;
+
+    for (int j = 0; j < header->ninsns; j++) {
+        IrInsn* insn = &header->insns[j];
+        if (insn->op == IR_PHI || insn->op == IR_BRANCH) continue;
+        int dst = ir_new_vreg(fn);
+        ir_append(entry, insn->op, dst, mapped(state, insn->a), mapped(state, insn->b), insn->imm);
+        state->map[insn->dst] = dst;
+    }
+
+    for (int i = 0; i < state->nbody; i++) {
+        state->clones[i] = ir_new_block(fn);
+        ir_place_block_after(fn, state->clones[i], *after);
+        *after = state->clones[i];
+    }
+    // Il corpo non ha cicli: in ordine RPO ogni registro è rinominato prima dei suoi usi
+    for (int i = 0; i < state->nbody; i++) {
+        IrBlock* block = state->body[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            if (insn->op == IR_JUMP || insn->op == IR_BRANCH) continue;
+            int dst = insn->dst ? ir_new_vreg(fn) : 0;
+            // Gli argomenti dei phi si copiano dopo, quando si conoscono i predecessori della copia
+            ir_append(state->clones[i], insn->op, dst, mapped(state, insn->a), mapped(state, insn->b), insn->imm);
+            if (insn->dst) state->map[insn->dst] = dst;
+        }
+    }
+
+    ir_jump(entry, state->clones[clone_index(state, state->body_entry)]);
+    for (int i = 0; i < state->nbody; i++) {
+        IrBlock* block = state->body[i];
+        IrInsn* last = ir_terminator(block);
+        if (block == state->latch) continue;
+        if (last->op == IR_JUMP) {
+            ir_jump(state->clones[i], state->clones[clone_index(state, block->succ[0])]);
+        } else {
+            ir_branch(state->clones[i], mapped(state, last->a),
+                      state->clones[clone_index(state, block->succ[0])],
+                      state->clones[clone_index(state, block->succ[1])]);
+        }
+    }
+
+    for (int i = 0; i < state->nbody; i++) {
+        IrBlock* block = state->body[i];
+        IrBlock* clone = state->clones[i];
+        for (int j = 0; j < block->ninsns && block->insns[j].op == IR_PHI; j++) {
+            IrInsn* phi = &clone->insns[j];
+            phi->args = (int*)unroll_alloc((size_t)clone->npreds, sizeof(int));
+            phi->nargs = clone->npreds;
+            for (int p = 0; p < clone->npreds; p++) {
+                // Il predecessore originale: l'header per entry, altrimenti il blocco copiato
+                IrBlock* original = clone->preds[p] == entry ? header : NULL;
+                for (int c = 0; c < state->nbody && !original; c++) {
+                    if (state->clones[c] == clone->preds[p]) original = state->body[c];
+                }
+                for (int q = 0; q < block->npreds; q++) {
+                    if (block->preds[q] == original) {
+                        phi->args[p] = mapped(state, block->insns[j].args[q]);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return state->clones[clone_index(state, state->latch)];
+}
+
+// Dopo una copia, i phi dell'header valgono gli argomenti dal latch rinominati.
+static void advance_header_values(UnrollState* state, int* values) {
+    IrBlock* header = state->loop->header;
+    int nphis = 0;
+    for (int j = 0; j < header->ninsns && header->insns[j].op == IR_PHI; j++) {
+        values[nphis++] = mapped(state, header->insns[j].args[1 - state->pre_index]);
+    }
+    for (int j = 0; j < nphis; j++) {
+        state->map[header->insns[j].dst] = values[j];
+    }
+}
+
+static void unroll_fully(UnrollState* state, int trips) {
+    IrFunction* fn = state->fn;
+    IrBlock* header = state->loop->header;
+    int* values = (int*)unroll_alloc((size_t)header->ninsns, sizeof(int));
+
+    for (int j = 0; j < header->ninsns && header->insns[j].op == IR_PHI; j++) {
+        state->map[header->insns[j].dst] = header->insns[j].args[state->pre_index];
+    }
+    IrBlock* entry = ir_new_block(fn);
+    ir_place_block_after(fn, entry, state->preheader);
+    IrBlock* after = entry;
+    ir_remove_terminator(state->preheader);
+    ir_jump(state->preheader, entry);
+
+    IrBlock* tail = entry;
+    for (int k = 0; k < trips; k++) {
+        tail = clone_iteration(state, tail, &after);
+        advance_header_values(state, values);
+    }
+    ir_jump_replacing(tail, header, state->preheader);
+    for (int j = 0; j < header->ninsns && header->insns[j].op == IR_PHI; j++) {
+        header->insns[j].args[state->pre_index] = mapped(state, header->insns[j].dst);
+    }
+    free(values);
+}
+
+static void unroll_partially(UnrollState* state, int factor) {
+    IrFunction* fn = state->fn;
+    IrBlock* header = state->loop->header;
+    IrBlock* preheader = state->preheader;
+    int* values = (int*)unroll_alloc((size_t)header->ninsns, sizeof(int));
+
+    // Limite del nuovo ciclo nel preheader: lim = n - (factor-1)*passo, oppure INT_MIN se trabocca
+    // (selezione senza salti: lim - (lim < n ? 0 : lim - INT_MIN))
+    int span = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_CONST, span, 0, 0, (factor - 1) * state->step);
+    int limit = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_SUB, limit, state->bound, span, 0);
+    int fits = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_LT, fits, limit, state->bound, 0);
+    int zero = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_CONST, zero, 0, 0, 0);
+    int overflow = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_EQ, overflow, fits, zero, 0);
+    int int_min = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_CONST, int_min, 0, 0, INT_MIN);
+    int distance = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_SUB, distance, limit, int_min, 0);
+    int correction = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_MUL, correction, overflow, distance, 0);
+    int safe_limit = ir_new_vreg(fn);
+    ir_insert(preheader, preheader->ninsns - 1, IR_SUB, safe_limit, limit, correction, 0);
+
+    // Header del nuovo ciclo: un phi per ogni phi dell'header originale
+    IrBlock* main_header = ir_new_block(fn);
+    ir_place_block_after(fn, main_header, preheader);
+    ir_remove_terminator(preheader);
+    ir_jump(preheader, main_header);
+    int nphis = 0;
+    for (int j = 0; j < header->ninsns && header->insns[j].op == IR_PHI; j++) {
+        int phi = ir_new_vreg(fn);
+        ir_append(main_header, IR_PHI, phi, 0, 0, 0);
+        state->map[header->insns[j].dst] = phi;
+        values[nphis++] = phi;
+    }
+    int cond = ir_new_vreg(fn);
+    ir_append(main_header, IR_LT, cond, mapped(state, state->iv), safe_limit, 0);
+    IrBlock* entry = ir_new_block(fn);
+    ir_place_block_after(fn, entry, main_header);
+    ir_branch_replacing(main_header, cond, entry, header, preheader);
+
+    IrBlock* after = entry;
+    IrBlock* tail = entry;
+    int* phis = (int*)unroll_alloc((size_t)nphis, sizeof(int));
+    for (int j = 0; j < nphis; j++) phis[j] = values[j];
+    for (int k = 0; k < factor; k++) {
+        tail = clone_iteration(state, tail, &after);
+        advance_header_values(state, values);
+    }
+    ir_jump(tail, main_header);
+
+    // main_header ha come predecessori il preheader e la coda delle copie
+    for (int j = 0; j < nphis; j++) {
+        IrInsn* phi = &main_header->insns[j];
+        phi->args = (int*)unroll_alloc(2, sizeof(int));
+        phi->nargs = 2;
+        phi->args[0] = header->insns[j].args[state->pre_index];
+        phi->args[1] = values[j];
+        // All'uscita dal nuovo ciclo l'header originale riceve i valori correnti
+        header->insns[j].args[state->pre_index] = phis[j];
+    }
+    free(phis);
+    free(values);
+}
+
+static int unroll_loop(UnrollState* state, int factor) {
+    int size = analyze_loop(state);
+    if (size == 0) return 0;
+
+    state->map_size = state->fn->nvregs + 1;
+    state->map = (int*)unroll_alloc((size_t)state->map_size, sizeof(int));
+    state->clones = (IrBlock**)unroll_alloc((size_t)state->nbody, sizeof(IrBlock*));
+
+    int init, bound, done = 0;
+    if (constant_value(state, state->init, &init) && constant_value(state, state->bound, &bound)) {
+        long long trips = init < bound ? ((long long)bound - init + state->step - 1) / state->step : 0;
+        // L'ultimo valore di i (quello che esce) non deve traboccare
+        if ((long long)init + trips * state->step <= INT_MAX && trips * size <= UNROLL_BUDGET) {
+            unroll_fully(state, (int)trips);
+            done = 1;
+        }
+    }
+    if (!done && factor * size <= UNROLL_BUDGET && (long long)(factor - 1) * state->step <= INT_MAX) {
+        unroll_partially(state, factor);
+        done = 1;
+    }
+
+    free(state->map);
+    free(state->clones);
+    return done;
+}
+
+void opt_unroll_loops(IrFunction* fn, int factor) {
+    if (fn->nloops == 0 || factor < 2) return;
+
+    // Gli header dei cicli da provare, scelti prima di cambiare il grafo: i cicli più interni
+    // sono disgiunti e quelli creati dallo srotolamento non vanno srotolati di nuovo.
+    IrBlock** headers = (IrBlock**)unroll_alloc((size_t)fn->nloops, sizeof(IrBlock*));
+    int nheaders = 0;
+    for (int l = 0; l < fn->nloops; l++) {
+        if (fn->loops[l]->nchildren == 0) headers[nheaders++] = fn->loops[l]->header;
+    }
+
+    UnrollState state;
+    state.fn = fn;
+    for (int h = 0; h < nheaders; h++) {
+        IrLoop* loop = NULL;
+        for (int l = 0; l < fn->nloops && !loop; l++) {
+            if (fn->loops[l]->header == headers[h]) loop = fn->loops[l];
+        }
+        if (!loop) continue;
+        state.loop = loop;
+        state.body = (IrBlock**)unroll_alloc((size_t)loop->nblocks, sizeof(IrBlock*));
+        int changed = unroll_loop(&state, factor);
+        free(state.body);
+        if (changed) cfg_build(fn);
+    }
+    free(headers);
+}
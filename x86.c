@@ -0,0 +1,651 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "ir.h"
+#include "asm.h"
+#include "regalloc.h"
+#include "x86.h"
+
+// Layout del frame, in parole da 4 byte: prima gli slot dei registri virtuali rimasti in memoria,
+// poi quelli dove si salvano i registri callee-saved usati dall'allocatore. Solo i registri
+// virtuali in memoria hanno uno slot; con l'allocazione dei registri quelli con intervalli di vita
+// disgiunti lo condividono (regalloc.c).
+// Senza allocazione la parola w è -4*(w+1)(%ebp); con l'allocazione il frame pointer si omette,
+// EBP diventa un registro allocabile e la parola w è 4*w(%esp): il corpo non fa push né chiamate,
+// quindi ESP non cambia dopo il prologo. Il frame è arrotondato perché ESP resti allineato a 16
+// byte, come vuole l'ABI ai punti di chiamata.
+// Ogni registro virtuale ha una posizione: un registro fisico scelto da regalloc.c, il suo slot
+// oppure, per le costanti usate solo dove l'istruzione x86 accetta un immediato, "$k".
+// EAX (ed EDX per la divisione) fa da registro di lavoro all'interno di una singola istruzione IR.
+
+typedef char Location[ASM_OPERAND_LEN];
+
+static IrFunction* fn = NULL;
+static AsmBuffer* out = NULL;
+static int* use_counts = NULL;
+// Registri definiti da un solo IR_CONST: moltiplicazioni e divisioni per loro usano l'immediato.
+static char* is_constant = NULL;
+static int* constant_value = NULL;
+static char* is_immediate = NULL;   // costanti senza posizione: ogni uso le legge come immediato
+static Location* locations = NULL;
+// Registri callee-saved usati (indici in regalloc_names) e slot in cui vengono salvati
+static int saved_regs[REGALLOC_NREGS];
+static int nsaved = 0;
+static int nspilled = 0;            // slot dei registri virtuali in memoria
+static int omit_frame_pointer = 0;
+static int frame_size = 0;          // byte sottratti a ESP nel prologo
+// Confronto del blocco corrente fuso con il branch finale: lascia il risultato solo nei flag,
+// e il branch salta con il jcc corrispondente invece di ritestare un booleano materializzato.
+static IrInsn* fused_compare = NULL;
+static int label_base = 0;   // i blocchi di ogni funzione ricevono etichette .L uniche nel file
+static int next_label_base = 0;
+
+// Operando in memoria per la parola word del frame.
+static void frame_operand(int word, char* operand) {
+    if (omit_frame_pointer) {
+        snprintf(operand, ASM_OPERAND_LEN, "%d(%%esp)", 4 * word);
+    } else {
+        snprintf(operand, ASM_OPERAND_LEN, "%d(%%ebp)", -4 * (word + 1));
+    }
+}
+
+static void emit_jump(const char* mnemonic, IrBlock* target) {
+    asm_emit(out, "%s .L%d", mnemonic, label_base + target->id);
+}
+
+static const char* location(int vreg) {
+    return locations[vreg];
+}
+
+static int is_register(const char* operand) {
+    return operand[0] == '%';
+}
+
+static int is_memory(const char* operand) {
+    return operand[0] != '%' && operand[0] != '$';
+}
+
+// movl tra due posizioni qualsiasi: da memoria a memoria si passa per EAX.
+static void move(const char* src, const char* dst) {
+    if (strcmp(src, dst) == 0) return;
+    if (is_memory(src) && is_memory(dst)) {
+        asm_emit(out, "movl %s, %%eax", src);
+        src = "%eax";
+    }
+    asm_emit(out, "movl %s, %s", src, dst);
+}
+
+static void load(int vreg, const char* reg) {
+    move(location(vreg), reg);
+}
+
+static void store(const char* reg, int vreg) {
+    move(reg, location(vreg));
+}
+
+static void move_immediate(int value, int vreg) {
+    char immediate[ASM_OPERAND_LEN];
+    snprintf(immediate, sizeof(immediate), "$%d", value);
+    move(immediate, location(vreg));
+}
+
+// Registro in cui calcolare un risultato destinato a dst: dst stesso se è un registro che non
+// va letto dopo essere stato sovrascritto (avoid), altrimenti EAX.
+static const char* work_register(int dst, int avoid) {
+    const char* target = location(dst);
+    if (is_register(target) && (!avoid || strcmp(target, location(avoid)) != 0)) return target;
+    return "%eax";
+}
+
+static void emit_epilogue(void) {
+    for (int k = 0; k < nsaved; k++) {
+        char saved[ASM_OPERAND_LEN];
+        frame_operand(nspilled + k, saved);
+        asm_emit(out, "movl %s, %s", saved, regalloc_names[saved_regs[k]]);
+    }
+    if (!omit_frame_pointer) {
+        asm_emit(out, "movl %%ebp, %%esp");
+        asm_emit(out, "popl %%ebp");
+    } else if (frame_size > 0) {
+        asm_emit(out, "addl $%d, %%esp", frame_size);
+    }
+    asm_emit(out, "ret");
+}
+
+static const char* setcc_name(IrOp op) {
+    switch (op) {
+        case IR_EQ: return "sete";
+        case IR_NE: return "setne";
+        case IR_LT: return "setl";
+        default: return "setg";
+    }
+}
+
+// Salto condizionato preso quando il confronto op è vero (o falso, con negate).
+static const char* jcc_name(IrOp op, int negate) {
+    switch (op) {
+        case IR_EQ: return negate ? "jne" : "je";
+        case IR_NE: return negate ? "je" : "jne";
+        case IR_LT: return negate ? "jge" : "jl";
+        default: return negate ? "jle" : "jg";
+    }
+}
+
+// Il confronto che decide il branch finale si può fondere con esso se il booleano non serve
+// ad altro e tra i due ci sono solo copie e costanti (movl, che non toccano i flag): di solito
+// sono le copie dei phi messe da ssa_destruct.
+static IrInsn* find_fused_compare(IrBlock* block) {
+    IrInsn* branch = ir_terminator(block);
+    if (!branch || branch->op != IR_BRANCH || use_counts[branch->a] != 1) return NULL;
+    for (int j = block->ninsns - 2; j >= 0; j--) {
+        IrInsn* insn = &block->insns[j];
+        if (insn->dst == branch->a) {
+            return insn->op == IR_EQ || insn->op == IR_NE || insn->op == IR_LT || insn->op == IR_GT ? insn : NULL;
+        }
+        if (insn->op != IR_COPY && insn->op != IR_CONST) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static int log2_exact(unsigned int k) {
+    if (k == 0 || (k & (k - 1)) != 0) return -1;
+    int n = 0;
+    while (k > 1) {
+        k >>= 1;
+        n++;
+    }
+    return n;
+}
+
+// Moltiplicazione per una costante: shift, lea con scala 2/4/8 (per 3, 5, 9) eventualmente seguita
+// da uno shift, neg per i negativi; negli altri casi imull con l'immediato.
+static void emit_mul_constant(int dst, int a, int k) {
+    unsigned int magnitude = k < 0 ? 0u - (unsigned int)k : (unsigned int)k;
+    if (k == 0 || is_immediate[a]) {
+        move_immediate((int)((unsigned int)constant_value[a] * (unsigned int)k), dst);
+        return;
+    }
+    int shift = log2_exact(magnitude);
+    int lea_scale = 0;
+    if (shift < 0) {
+        static const int factors[] = { 3, 5, 9 };
+        for (int f = 0; f < 3 && shift < 0; f++) {
+            if (magnitude % (unsigned int)factors[f] == 0 && log2_exact(magnitude / (unsigned int)factors[f]) >= 0) {
+                lea_scale = factors[f] - 1;
+                shift = log2_exact(magnitude / (unsigned int)factors[f]);
+            }
+        }
+    }
+    const char* work = work_register(dst, 0);
+    if (shift < 0 || k == INT_MIN) {
+        asm_emit(out, "imull $%d, %s, %s", k, location(a), work);
+        store(work, dst);
+        return;
+    }
+    load(a, work);
+    if (lea_scale) {
+        asm_emit(out, "leal (%s,%s,%d), %s", work, work, lea_scale, work);
+    }
+    if (shift > 0) {
+        asm_emit(out, "shll $%d, %s", shift, work);
+    }
+    if (k < 0) {
+        asm_emit(out, "negl %s", work);
+    }
+    store(work, dst);
+}
+
+// Costanti "magiche" per la divisione con segno (Hacker's Delight, 10-1): per 2 <= |d| < 2^31,
+// q = ((M * n) >> (32 + s)) corretto di n se M e d hanno segni diversi, più 1 se q è negativo.
+static void signed_magic(int d, int* multiplier, int* shift) {
+    const unsigned int two31 = 0x80000000u;
+    unsigned int ad = d < 0 ? 0u - (unsigned int)d : (unsigned int)d;
+    unsigned int t = two31 + ((unsigned int)d >> 31);
+    unsigned int anc = t - 1 - t % ad;
+    unsigned int q1 = two31 / anc, r1 = two31 - q1 * anc;
+    unsigned int q2 = two31 / ad, r2 = two31 - q2 * ad;
+    unsigned int delta;
+    int p = 31;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    *multiplier = (int)(q2 + 1);
+    if (d < 0) *multiplier = -*multiplier;
+    *shift = p - 32;
+}
+
+// Divisione (troncata verso zero) per una costante: niente idivl.
+static void emit_div_constant(int dst, int a, int d) {
+    unsigned int magnitude = d < 0 ? 0u - (unsigned int)d : (unsigned int)d;
+    int shift = log2_exact(magnitude);
+    int quotient;
+    if (is_immediate[a] && ir_eval_binary(IR_DIV, constant_value[a], d, &quotient)) {
+        // cmpl e imull a un operando non accettano un immediato: con il dividendo costante si calcola qui
+        move_immediate(quotient, dst);
+        return;
+    }
+    if (d == INT_MIN) {
+        // Solo INT_MIN / INT_MIN fa 1, ogni altro dividendo dà 0
+        asm_emit(out, "cmpl $%d, %s", INT_MIN, location(a));
+        asm_emit(out, "sete %%al");
+        asm_emit(out, "movzbl %%al, %%eax");
+    } else if (shift == 0) {
+        load(a, "%eax");
+    } else if (shift > 0) {
+        // Lo shift aritmetico arrotonda verso -inf: ai negativi si somma prima |d| - 1
+        load(a, "%eax");
+        asm_emit(out, "cdq");
+        asm_emit(out, "andl $%u, %%edx", magnitude - 1);
+        asm_emit(out, "addl %%edx, %%eax");
+        asm_emit(out, "sarl $%d, %%eax", shift);
+    } else {
+        int multiplier, magic_shift;
+        signed_magic(d, &multiplier, &magic_shift);
+        asm_emit(out, "movl $%d, %%eax", multiplier);
+        asm_emit(out, "imull %s", location(a));
+        if (d > 0 && multiplier < 0) {
+            asm_emit(out, "addl %s, %%edx", location(a));
+        } else if (d < 0 && multiplier > 0) {
+            asm_emit(out, "subl %s, %%edx", location(a));
+        }
+        if (magic_shift > 0) {
+            asm_emit(out, "sarl $%d, %%edx", magic_shift);
+        }
+        asm_emit(out, "movl %%edx, %%eax");
+        asm_emit(out, "shrl $31, %%eax");
+        asm_emit(out, "addl %%edx, %%eax");
+    }
+    if (d < 0 && d != INT_MIN && shift >= 0) {
+        asm_emit(out, "negl %%eax");
+    }
+    store("%eax", dst);
+}
+
+// Quali operandi di MUL e DIV diventano immediati (per MUL anche il primo, è commutativa).
+static int mul_constant_operand(IrInsn* insn) {
+    if (is_constant[insn->b]) return insn->b;
+    if (is_constant[insn->a]) return insn->a;
+    return 0;
+}
+
+// Le costanti diventano immediati se nessun uso richiede un registro o la memoria:
+// la condizione di un branch e il divisore 0 (idivl non ha la forma con immediato).
+static void find_constants(void) {
+    int* defs = (int*)calloc((size_t)fn->nvregs + 1, sizeof(int));
+    is_constant = (char*)calloc((size_t)fn->nvregs + 1, 1);
+    constant_value = (int*)calloc((size_t)fn->nvregs + 1, sizeof(int));
+    is_immediate = (char*)calloc((size_t)fn->nvregs + 1, 1);
+    if (!defs || !is_constant || !constant_value || !is_immediate) {
+        perror("Errore di allocazione del backend");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            if (!insn->dst) continue;
+            defs[insn->dst]++;
+            if (insn->op == IR_CONST) constant_value[insn->dst] = insn->imm;
+            is_constant[insn->dst] = insn->op == IR_CONST;
+        }
+    }
+    for (int v = 1; v <= fn->nvregs; v++) {
+        if (defs[v] != 1) is_constant[v] = 0;
+        is_immediate[v] = is_constant[v];
+    }
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        for (int j = 0; j < block->ninsns; j++) {
+            IrInsn* insn = &block->insns[j];
+            if (insn->op == IR_BRANCH) {
+                is_immediate[insn->a] = 0;
+            } else if (insn->op == IR_DIV && is_constant[insn->b] && constant_value[insn->b] == 0) {
+                is_immediate[insn->b] = 0;
+            }
+        }
+    }
+    free(defs);
+}
+
+static void assign_locations(X86Allocation allocation) {
+    int* assignment = NULL;
+    int* slots = NULL;
+    char* candidate = (char*)malloc((size_t)fn->nvregs + 1);
+    if (!candidate) {
+        perror("Errore di allocazione del backend");
+        exit(EXIT_FAILURE);
+    }
+    for (int v = 0; v <= fn->nvregs; v++) candidate[v] = !is_immediate[v];
+    omit_frame_pointer = allocation != X86_STACK_SLOTS;
+    if (allocation != X86_STACK_SLOTS) {
+        assignment = allocation == X86_GRAPH_COLORING ? regalloc_graph_coloring(fn, candidate)
+                                                      : regalloc_linear_scan(fn, candidate);
+        for (int v = 0; v <= fn->nvregs; v++) candidate[v] = candidate[v] && assignment[v] < 0;
+        slots = regalloc_share_slots(fn, candidate, &nspilled);
+    } else {
+        // Uno slot per ogni registro virtuale che compare nel codice, nell'ordine dei numeri
+        slots = (int*)malloc(((size_t)fn->nvregs + 1) * sizeof(int));
+        char* referenced = (char*)calloc((size_t)fn->nvregs + 1, 1);
+        if (!slots || !referenced) {
+            perror("Errore di allocazione del backend");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < fn->nblocks; i++) {
+            IrBlock* block = fn->blocks[i];
+            for (int j = 0; j < block->ninsns; j++) {
+                IrInsn* insn = &block->insns[j];
+                int count = ir_operand_count(insn);
+                referenced[insn->dst] = 1;
+                for (int k = 0; k < count; k++) referenced[*ir_operand(insn, k)] = 1;
+            }
+        }
+        nspilled = 0;
+        for (int v = 0; v <= fn->nvregs; v++) {
+            slots[v] = v > 0 && candidate[v] && referenced[v] ? nspilled++ : -1;
+        }
+        free(referenced);
+    }
+    free(candidate);
+
+    locations = (Location*)calloc((size_t)fn->nvregs + 1, sizeof(Location));
+    if (!locations) {
+        perror("Errore di allocazione del backend");
+        exit(EXIT_FAILURE);
+    }
+    int used[REGALLOC_NREGS] = { 0 };
+    for (int v = 1; v <= fn->nvregs; v++) {
+        if (is_immediate[v]) {
+            snprintf(locations[v], sizeof(Location), "$%d", constant_value[v]);
+        } else if (assignment && assignment[v] >= 0) {
+            snprintf(locations[v], sizeof(Location), "%s", regalloc_names[assignment[v]]);
+            used[assignment[v]] = 1;
+        } else if (slots[v] >= 0) {
+            frame_operand(slots[v], locations[v]);
+        }
+    }
+    // ECX è caller-saved; EBX, ESI, EDI ed EBP vanno restituiti al chiamante come li ha lasciati
+    nsaved = 0;
+    for (int r = 0; r < REGALLOC_NREGS; r++) {
+        if (used[r] && strcmp(regalloc_names[r], "%ecx") != 0) saved_regs[nsaved++] = r;
+    }
+    free(assignment);
+    free(slots);
+
+    // All'ingresso ESP + 4 è allineato a 16; il push di EBP, se c'è, conta come una parola del frame
+    int words = nspilled + nsaved;
+    frame_size = 0;
+    if (words > 0) {
+        int pushed = omit_frame_pointer ? 4 : 8;
+        frame_size = ((4 * words + pushed + 15) & ~15) - pushed;
+    }
+}
+
+// "mnemonic src, dst"; addl e subl dell'immediato 1 o -1 diventano incl e decl, più corte.
+static void emit_alu(const char* mnemonic, const char* src, const char* dst) {
+    int add = strcmp(mnemonic, "addl") == 0;
+    int sub = strcmp(mnemonic, "subl") == 0;
+    if ((add || sub) && (strcmp(src, "$1") == 0 || strcmp(src, "$-1") == 0)) {
+        int increment = add == (strcmp(src, "$1") == 0);
+        asm_emit(out, "%s %s", increment ? "incl" : "decl", dst);
+        return;
+    }
+    asm_emit(out, "%s %s, %s", mnemonic, src, dst);
+}
+
+// Operazione a due indirizzi dst = a op b: si calcola in dst se è un registro, altrimenti in EAX.
+static void emit_binary(const char* mnemonic, IrInsn* insn, int commutative) {
+    int a = insn->a, b = insn->b;
+    if (commutative && is_register(location(insn->dst)) && strcmp(location(b), location(insn->dst)) == 0) {
+        a = insn->b;
+        b = insn->a;
+    }
+    const char* work = work_register(insn->dst, b);
+    load(a, work);
+    emit_alu(mnemonic, location(b), work);
+    store(work, insn->dst);
+}
+
+// Selezione a copertura massima (maximal munch) per l'indirizzamento con indice scalato:
+// la moltiplicazione per 2, 4 o 8 che precede un'addizione e serve solo a lei le si unisce in un
+// leal. Restituisce la moltiplicazione assorbita da insn, NULL se non ce n'è una.
+static IrInsn* scaled_operand(IrBlock* block, IrInsn* insn) {
+    if (insn->op != IR_ADD || insn == block->insns) return NULL;
+    IrInsn* mul = insn - 1;
+    if (mul->op != IR_MUL || (mul->dst != insn->a && mul->dst != insn->b) || use_counts[mul->dst] != 1) return NULL;
+    int k = mul_constant_operand(mul);
+    if (!k) return NULL;
+    int index = k == mul->b ? mul->a : mul->b;
+    if (is_constant[index]) return NULL;
+    int scale = constant_value[k];
+    return scale == 2 || scale == 4 || scale == 8 ? mul : NULL;
+}
+
+// dst = base + index * scala con un solo leal; gli operandi in memoria passano da EAX ed EDX.
+static void emit_scaled_add(IrInsn* insn, IrInsn* mul) {
+    int k = mul_constant_operand(mul);
+    int index = k == mul->b ? mul->a : mul->b;
+    int base = insn->a == mul->dst ? insn->b : insn->a;
+    const char* index_reg = location(index);
+    if (!is_register(index_reg)) {
+        move(index_reg, "%edx");
+        index_reg = "%edx";
+    }
+    const char* work = work_register(insn->dst, 0);
+    if (is_immediate[base]) {
+        asm_emit(out, "leal %d(,%s,%d), %s", constant_value[base], index_reg, constant_value[k], work);
+    } else {
+        const char* base_reg = location(base);
+        if (!is_register(base_reg)) {
+            move(base_reg, "%eax");
+            base_reg = "%eax";
+        }
+        asm_emit(out, "leal (%s,%s,%d), %s", base_reg, index_reg, constant_value[k], work);
+    }
+    store(work, insn->dst);
+}
+
+// Addizione e sottrazione. Se dst è un registro diverso dagli operandi, leal calcola il risultato
+// a tre indirizzi senza la copia preliminare di emit_binary (registro + registro o + immediato).
+static void emit_add_sub(IrInsn* insn) {
+    const char* dst = location(insn->dst);
+    const char* a = location(insn->a);
+    const char* b = location(insn->b);
+    int add = insn->op == IR_ADD;
+    if (is_register(dst) && strcmp(dst, a) != 0 && (!add || strcmp(dst, b) != 0)) {
+        if (add && is_register(a) && is_register(b)) {
+            asm_emit(out, "leal (%s,%s), %s", a, b, dst);
+            return;
+        }
+        if (is_register(a) && is_immediate[insn->b]) {
+            unsigned int value = (unsigned int)constant_value[insn->b];
+            asm_emit(out, "leal %d(%s), %s", (int)(add ? value : 0u - value), a, dst);
+            return;
+        }
+        if (add && is_immediate[insn->a] && is_register(b)) {
+            asm_emit(out, "leal %d(%s), %s", constant_value[insn->a], b, dst);
+            return;
+        }
+    }
+    emit_binary(add ? "addl" : "subl", insn, add);
+}
+
+// cmpl b, a: il primo operando dell'istruzione x86 è il secondo del confronto.
+static void emit_compare(IrInsn* insn) {
+    const char* a = location(insn->a);
+    const char* b = location(insn->b);
+    if (is_register(a) || (is_memory(a) && !is_memory(b))) {
+        asm_emit(out, "cmpl %s, %s", b, a);
+    } else {
+        move(a, "%eax");
+        asm_emit(out, "cmpl %s, %%eax", b);
+    }
+}
+
+// next è il blocco emesso subito dopo, verso cui si può cadere senza salto.
+static void emit_insn(IrBlock* block, IrInsn* insn, IrBlock* next) {
+    switch (insn->op) {
+        case IR_CONST:
+            if (is_immediate[insn->dst]) break;
+            move_immediate(insn->imm, insn->dst);
+            break;
+        case IR_COPY:
+            move(location(insn->a), location(insn->dst));
+            break;
+        case IR_ADD:
+        case IR_SUB: {
+            IrInsn* mul = scaled_operand(block, insn);
+            if (mul) {
+                emit_scaled_add(insn, mul);
+            } else {
+                emit_add_sub(insn);
+            }
+            break;
+        }
+        case IR_MUL:
+            // Assorbita dall'addizione che segue (scaled_operand)
+            if (insn + 1 < block->insns + block->ninsns && scaled_operand(block, insn + 1) == insn) break;
+            if (mul_constant_operand(insn)) {
+                int k = mul_constant_operand(insn);
+                emit_mul_constant(insn->dst, k == insn->b ? insn->a : insn->b, constant_value[k]);
+                break;
+            }
+            emit_binary("imull", insn, 1);
+            break;
+        case IR_DIV:
+            if (is_constant[insn->b] && constant_value[insn->b] != 0) {
+                emit_div_constant(insn->dst, insn->a, constant_value[insn->b]);
+                break;
+            }
+            // Dividendo in EDX:EAX (esteso con cdq), divisore direttamente dalla sua posizione.
+            load(insn->a, "%eax");
+            asm_emit(out, "cdq");
+            asm_emit(out, "idivl %s", location(insn->b));
+            store("%eax", insn->dst);
+            break;
+        case IR_EQ:
+        case IR_NE:
+        case IR_LT:
+        case IR_GT:
+            emit_compare(insn);
+            if (insn == fused_compare) break;
+            asm_emit(out, "%s %%al", setcc_name(insn->op));
+            if (is_register(location(insn->dst))) {
+                asm_emit(out, "movzbl %%al, %s", location(insn->dst));
+            } else {
+                asm_emit(out, "movzbl %%al, %%eax");
+                store("%eax", insn->dst);
+            }
+            break;
+        case IR_PHI:
+            fprintf(stderr, "Errore interno: phi non eliminato prima del backend.\n");
+            exit(EXIT_FAILURE);
+        case IR_JUMP:
+            if (block->succ[0] != next) {
+                emit_jump("jmp", block->succ[0]);
+            }
+            break;
+        case IR_BRANCH: {
+            // Senza confronto fuso si ritesta il booleano: "vero" è diverso da zero
+            IrOp cond = IR_NE;
+            if (fused_compare) {
+                cond = fused_compare->op;
+            } else {
+                if (is_register(location(insn->a))) {
+                    asm_emit(out, "testl %s, %s", location(insn->a), location(insn->a));
+                } else {
+                    asm_emit(out, "cmpl $0, %s", location(insn->a));
+                }
+            }
+            if (block->succ[1] == next) {
+                emit_jump(jcc_name(cond, 0), block->succ[0]);
+            } else if (block->succ[0] == next) {
+                emit_jump(jcc_name(cond, 1), block->succ[1]);
+            } else {
+                emit_jump(jcc_name(cond, 0), block->succ[0]);
+                emit_jump("jmp", block->succ[1]);
+            }
+            break;
+        }
+        case IR_RET:
+            load(insn->a, "%eax");
+            emit_epilogue();
+            break;
+    }
+}
+
+void emit_function(IrFunction* function, AsmBuffer* code, X86Allocation allocation) {
+    fn = function;
+    out = code;
+    label_base = next_label_base;
+    next_label_base += fn->next_block_id;
+    use_counts = ir_use_counts(fn);
+    find_constants();
+    assign_locations(allocation);
+
+    asm_emit(out, ".globl %s", fn->name);
+    asm_label(out, "%s", fn->name);
+    if (!omit_frame_pointer) {
+        asm_emit(out, "pushl %%ebp");
+        asm_emit(out, "movl %%esp, %%ebp");
+    }
+    if (frame_size > 0) {
+        asm_emit(out, "subl $%d, %%esp", frame_size);
+    }
+    for (int k = 0; k < nsaved; k++) {
+        char saved[ASM_OPERAND_LEN];
+        frame_operand(nspilled + k, saved);
+        asm_emit(out, "movl %s, %s", regalloc_names[saved_regs[k]], saved);
+    }
+
+    for (int i = 0; i < fn->nblocks; i++) {
+        IrBlock* block = fn->blocks[i];
+        IrBlock* next = i + 1 < fn->nblocks ? fn->blocks[i + 1] : NULL;
+        // L'ingresso non ha bisogno di etichetta se ci si arriva solo dal prologo.
+        if (i > 0 || block->npreds > 0) {
+            // Gli header dei cicli vengono allineati: il salto all'indietro di ogni iterazione
+            // arriva su un'istruzione all'inizio di una linea di cache.
+            if (block->loop && block->loop->header == block) {
+                asm_emit(out, ".p2align 4,,10");
+            }
+            asm_label(out, ".L%d", label_base + block->id);
+        }
+        fused_compare = find_fused_compare(block);
+        for (int j = 0; j < block->ninsns; j++) {
+            emit_insn(block, &block->insns[j], next);
+        }
+    }
+
+    free(use_counts);
+    free(is_constant);
+    free(constant_value);
+    free(is_immediate);
+    free(locations);
+    use_counts = NULL;
+    is_constant = NULL;
+    constant_value = NULL;
+    is_immediate = NULL;
+    locations = NULL;
+    nsaved = 0;
+    nspilled = 0;
+    omit_frame_pointer = 0;
+    frame_size = 0;
+    fused_compare = NULL;
+    fn = NULL;
+    out = NULL;
+}
@@ -0,0 +1,17 @@
+#ifndef X86_H
+#define X86_H
+
+#include "ir.h"
+#include "asm.h"
+
+// Posizione dei registri virtuali nel codice emesso
+typedef enum {
+    X86_STACK_SLOTS,    // ognuno nel suo slot del frame
+    X86_LINEAR_SCAN,    // registri fisici scelti dalla scansione lineare (regalloc.c)
+    X86_GRAPH_COLORING  // registri fisici scelti colorando il grafo delle interferenze (coloring.c)
+} X86Allocation;
+
+// Backend i386: traduce una funzione IR in assembly (sintassi AT&T), accodandolo al buffer.
+void emit_function(IrFunction* fn, AsmBuffer* code, X86Allocation allocation);
+
+#endif // X86_H